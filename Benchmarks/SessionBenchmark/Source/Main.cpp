@@ -0,0 +1,527 @@
+/*
+  ==============================================================================
+
+    Session scaling benchmark. Runs N A3AudioProcessor instances, each with a
+    random parameter state, from a simulated host graph on a shared worker pool,
+    and reports xrun rate, callback latency percentiles, resident memory and
+    per-instance footprint for every (instances, threads) pair.
+
+    Every pair runs in a fresh child process, so its memory figures aren't
+    flattered by allocations the previous pair freed back to the allocator.
+    QUALITY is pinned rather than randomised, since Auto would change tier with
+    each row's contention; --quality sweeps it instead. --ir loads an impulse
+    response into every instance and keeps their reverbs on, which brings in the
+    convolution stage.
+
+    The graph is a set of tracks, each a short serial chain of instances, all
+    summed into a master bus. Every callback hands the tracks out to the pool,
+    waits for all of them, then mixes on the calling thread, like a host's audio
+    callback would. Callbacks run back to back, so the numbers are compute time
+    against the real-time budget rather than wall-clock scheduling jitter.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+
+#include <algorithm>
+#include <optional>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+#if JUCE_MAC
+#include <mach/mach.h>
+#endif
+
+namespace {
+struct Options {
+    juce::Array<int> instanceCounts{1, 25, 50, 100, 200};
+    juce::Array<int> threadCounts{1, 2, 4, 8};
+    int              blockSize       = 256;
+    double           sampleRate      = 48000.0;
+    int              pluginsPerTrack = 2;
+    double           seconds         = 5.0;
+    int              minCallbacks    = 10000;
+    bool             runFloat        = true;
+    bool             runDouble       = false;
+    juce::Array<int> qualities{QualityParams::NORMAL};
+    juce::File       impulseResponse;
+    int              seed            = 1;
+};
+
+struct Result {
+    double meanMs           = 0.0;
+    double p99Ms            = 0.0;
+    double p999Ms           = 0.0;
+    double maxMs            = 0.0;
+    double budgetMs         = 0.0;
+    double xrunRate         = 0.0;
+    size_t residentBytes    = 0;
+    double bytesPerInstance = 0.0;
+    int    numCallbacks     = 0;
+};
+
+constexpr int    WARMUP_CALLBACKS   = 50;
+constexpr int    NOISE_BLOCKS       = 16;
+constexpr int    P999_MIN_CALLBACKS = 10000; // fewer than this and p99.9 is little more than the max
+constexpr double IR_TIMEOUT_SECONDS = 120.0;
+constexpr auto   RESULT_PREFIX      = "RESULT ";
+
+// Indexed by QualityParams value - 1
+constexpr const char *QUALITY_NAMES[] = {"eco", "normal", "high", "auto"};
+
+//==============================================================================
+size_t getResidentBytes() {
+#if JUCE_LINUX
+    std::ifstream status("/proc/self/status");
+    for (std::string line; std::getline(status, line);)
+        if (line.rfind("VmRSS:", 0) == 0)
+            return (size_t) std::strtoull(line.c_str() + 6, nullptr, 10) * 1024;
+    return 0;
+#elif JUCE_MAC
+    mach_task_basic_info_data_t info;
+    mach_msg_type_number_t      count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t) &info, &count) != KERN_SUCCESS)
+        return 0;
+    return (size_t) info.resident_size;
+#else
+    return 0;
+#endif
+}
+
+juce::Array<int> parseList(const juce::String &text, const juce::Array<int> &fallback) {
+    if (text.isEmpty())
+        return fallback;
+
+    juce::Array<int> values;
+    for (auto &token : juce::StringArray::fromTokens(text, ",", ""))
+        if (token.getIntValue() > 0)
+            values.add(token.getIntValue());
+
+    return values.isEmpty() ? fallback : values;
+}
+
+juce::Array<int> parseQualities(const juce::String &text, const juce::Array<int> &fallback) {
+    juce::Array<int> values;
+    for (auto &token : juce::StringArray::fromTokens(text, ",", ""))
+        for (int quality = QualityParams::QUALITY_MIN; quality <= QualityParams::QUALITY_MAX; ++quality)
+            if (token.trim().equalsIgnoreCase(QUALITY_NAMES[quality - 1]))
+                values.addIfNotAlreadyThere(quality);
+
+    return values.isEmpty() ? fallback : values;
+}
+
+//==============================================================================
+/**
+    Fixed pool of host worker threads. The calling thread joins in as one of the
+    workers, so a pool of N threads starts N - 1 extra ones.
+ */
+class HostThreadPool {
+public:
+    explicit HostThreadPool(int numThreads) {
+        for (int i = 1; i < numThreads; ++i)
+            workers.emplace_back([this] { workerLoop(); });
+    }
+
+    ~HostThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            quit = true;
+            ++generation;
+        }
+        wake.notify_all();
+
+        for (auto &worker : workers)
+            worker.join();
+    }
+
+    // Runs job(i) for every i in [0, numJobs) and returns once they have all finished
+    void run(int numJobs, const std::function<void(int)> &jobToRun) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job             = &jobToRun;
+            totalJobs       = numJobs;
+            finishedWorkers = 0;
+            nextJob.store(0);
+            ++generation;
+        }
+        wake.notify_all();
+
+        drain();
+
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [this] { return finishedWorkers == workers.size(); });
+    }
+
+private:
+    void workerLoop() {
+        juce::uint64 seenGeneration = 0;
+
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return generation != seenGeneration; });
+                seenGeneration = generation;
+                if (quit)
+                    return;
+            }
+
+            drain();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ++finishedWorkers;
+            }
+            done.notify_one();
+        }
+    }
+
+    void drain() {
+        for (int i; (i = nextJob.fetch_add(1)) < totalJobs;)
+            (*job)(i);
+    }
+
+    std::vector<std::thread>         workers;
+    std::mutex                       mutex;
+    std::condition_variable          wake;
+    std::condition_variable          done;
+    const std::function<void(int)>  *job             = nullptr;
+    int                              totalJobs       = 0;
+    std::atomic<int>                 nextJob{0};
+    size_t                           finishedWorkers = 0;
+    juce::uint64                     generation      = 0;
+    bool                             quit            = false;
+};
+
+//==============================================================================
+// The handover only happens inside processBlock, so keep feeding silence until every instance has taken its IR
+template <typename SampleType>
+bool waitForImpulseResponses(const Options &options, std::vector<std::unique_ptr<A3AudioProcessor>> &processors) {
+    juce::AudioBuffer<SampleType> silence(2, options.blockSize);
+    juce::MidiBuffer              midi;
+
+    auto deadline = juce::Time::getMillisecondCounterHiRes() + 1000.0 * IR_TIMEOUT_SECONDS;
+
+    for (;;) {
+        bool allLoaded = true;
+        for (auto &processor : processors) {
+            if (processor->hasImpulseResponse())
+                continue;
+
+            allLoaded = false;
+            silence.clear();
+            processor->processBlock(silence, midi);
+        }
+
+        if (allLoaded)
+            return true;
+        if (juce::Time::getMillisecondCounterHiRes() > deadline)
+            return false;
+
+        juce::Thread::sleep(1);
+    }
+}
+
+template <typename SampleType>
+std::optional<Result> runSession(const Options &options, int numInstances, int numThreads, int quality,
+                                 juce::Random &random) {
+    Result result;
+    auto   residentBefore = getResidentBytes();
+
+    std::vector<std::unique_ptr<A3AudioProcessor>> processors;
+    for (int i = 0; i < numInstances; ++i) {
+        auto processor = std::make_unique<A3AudioProcessor>();
+
+        // Every parameter from createParameterLayout() gets a random normalised value, except the pinned QUALITY
+        for (auto *parameter : processor->getParameters())
+            parameter->setValueNotifyingHost(random.nextFloat());
+
+        auto *qualityParameter = processor->apvts.getParameter("QUALITY");
+        qualityParameter->setValueNotifyingHost(qualityParameter->convertTo0to1((float) quality));
+
+        // A bypassed reverb never reaches the convolver, so with an IR every instance keeps its reverb on
+        if (options.impulseResponse != juce::File())
+            processor->apvts.getParameter("REVERB_BYPASS")->setValueNotifyingHost(0.0f);
+
+        processor->setProcessingPrecision(std::is_same_v<SampleType, double> ? juce::AudioProcessor::doublePrecision
+                                                                              : juce::AudioProcessor::singlePrecision);
+        processor->setPlayConfigDetails(2, 2, options.sampleRate, options.blockSize);
+        processor->prepareToPlay(options.sampleRate, options.blockSize);
+
+        if (options.impulseResponse != juce::File())
+            processor->loadImpulseResponse(options.impulseResponse);
+
+        processors.push_back(std::move(processor));
+    }
+
+    if (options.impulseResponse != juce::File() && !waitForImpulseResponses<SampleType>(options, processors)) {
+        std::fprintf(stderr, "Timed out loading %s\n", options.impulseResponse.getFullPathName().toRawUTF8());
+        return std::nullopt;
+    }
+
+    result.residentBytes    = getResidentBytes();
+    result.bytesPerInstance = ((double) result.residentBytes - (double) residentBefore) / numInstances;
+
+    auto numTracks = (numInstances + options.pluginsPerTrack - 1) / options.pluginsPerTrack;
+
+    juce::AudioBuffer<SampleType> noise(2, options.blockSize * NOISE_BLOCKS);
+    for (int ch = 0; ch < noise.getNumChannels(); ++ch)
+        for (int i = 0; i < noise.getNumSamples(); ++i)
+            noise.setSample(ch, i, static_cast<SampleType>(random.nextFloat() * 0.5f - 0.25f));
+
+    std::vector<juce::AudioBuffer<SampleType>> trackBuffers((size_t) numTracks,
+                                                            juce::AudioBuffer<SampleType>(2, options.blockSize));
+    std::vector<juce::MidiBuffer>              trackMidi((size_t) numTracks);
+    juce::AudioBuffer<SampleType>              master(2, options.blockSize);
+    int                                        noiseOffset = 0;
+
+    std::function<void(int)> processTrack = [&](int track) {
+        auto &buffer = trackBuffers[(size_t) track];
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+            buffer.copyFrom(ch, 0, noise, ch, noiseOffset, options.blockSize);
+
+        auto first = track * options.pluginsPerTrack;
+        auto last  = juce::jmin(numInstances, first + options.pluginsPerTrack);
+        for (auto i = first; i < last; ++i)
+            processors[(size_t) i]->processBlock(buffer, trackMidi[(size_t) track]);
+    };
+
+    HostThreadPool pool(numThreads);
+
+    auto numCallbacks = juce::jmax(options.minCallbacks,
+                                   (int) std::ceil(options.seconds * options.sampleRate / options.blockSize));
+    std::vector<double> latencies;
+    latencies.reserve((size_t) numCallbacks);
+
+    for (int callback = 0; callback < WARMUP_CALLBACKS + numCallbacks; ++callback) {
+        auto start = juce::Time::getHighResolutionTicks();
+
+        pool.run(numTracks, processTrack);
+
+        master.clear();
+        for (auto &buffer : trackBuffers)
+            for (int ch = 0; ch < master.getNumChannels(); ++ch)
+                master.addFrom(ch, 0, buffer, ch, 0, options.blockSize);
+
+        auto elapsed = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+        if (callback >= WARMUP_CALLBACKS)
+            latencies.push_back(elapsed * 1000.0);
+
+        noiseOffset = (noiseOffset + options.blockSize) % noise.getNumSamples();
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [&](double p) {
+        auto index = (size_t) std::ceil(p * (double) latencies.size());
+        return latencies[juce::jlimit((size_t) 0, latencies.size() - 1, index == 0 ? 0 : index - 1)];
+    };
+
+    result.numCallbacks = (int) latencies.size();
+    result.budgetMs     = 1000.0 * options.blockSize / options.sampleRate;
+    result.meanMs   = std::accumulate(latencies.begin(), latencies.end(), 0.0) / (double) latencies.size();
+    result.p99Ms    = percentile(0.99);
+    result.p999Ms   = percentile(0.999);
+    result.maxMs    = latencies.back();
+    result.xrunRate = (double) std::count_if(latencies.begin(), latencies.end(),
+                                             [&](double ms) { return ms > result.budgetMs; }) /
+                      (double) latencies.size();
+
+    return result;
+}
+
+void printUsage() {
+    std::printf("Usage: SessionBenchmark [options]\n"
+                "  --instances=1,25,50,100,200  instance counts to sweep\n"
+                "  --threads=1,2,4,8            host worker thread counts to sweep\n"
+                "  --block=256                  buffer size in samples\n"
+                "  --rate=48000                 sample rate in Hz\n"
+                "  --chain=2                    instances in series per track\n"
+                "  --seconds=5                  simulated audio per measurement\n"
+                "  --min-callbacks=10000        fewest measured callbacks; p99.9 needs 10000\n"
+                "  --precision=float            float, double or both\n"
+                "  --quality=normal             eco, normal, high or auto; a comma list sweeps them\n"
+                "  --ir=<file>                  impulse response loaded into every instance, reverb on\n"
+                "  --seed=1                     seed for the random parameter states\n");
+}
+
+//==============================================================================
+// Worker side: runs the one configuration on its command line and prints its result on a single line
+int runWorker(const Options &options, const juce::ArgumentList &args) {
+    auto numInstances = options.instanceCounts.getFirst();
+    auto numThreads   = options.threadCounts.getFirst();
+    auto quality      = options.qualities.getFirst();
+
+    juce::Random random(options.seed + numInstances);
+    auto         result = args.getValueForOption("--precision") == "double"
+                              ? runSession<double>(options, numInstances, numThreads, quality, random)
+                              : runSession<float>(options, numInstances, numThreads, quality, random);
+    if (!result)
+        return 1;
+
+    std::printf("%s%.6f %.6f %.6f %.6f %.6f %.8f %.0f %.1f %d\n", RESULT_PREFIX, result->meanMs, result->p99Ms,
+                result->p999Ms, result->maxMs, result->budgetMs, result->xrunRate, (double) result->residentBytes,
+                result->bytesPerInstance, result->numCallbacks);
+    return 0;
+}
+
+//==============================================================================
+// Parent side: runs one configuration in a fresh copy of this executable and reads its result back. On failure,
+// error holds the last thing the worker printed.
+std::optional<Result> runConfiguration(const Options &options, const char *precision, int quality, int numInstances,
+                                       int numThreads, juce::String &error) {
+    juce::StringArray command{
+        juce::File::getSpecialLocation(juce::File::currentExecutableFile).getFullPathName(),
+        "--worker",
+        "--instances=" + juce::String(numInstances),
+        "--threads=" + juce::String(numThreads),
+        "--block=" + juce::String(options.blockSize),
+        "--rate=" + juce::String(options.sampleRate),
+        "--chain=" + juce::String(options.pluginsPerTrack),
+        "--seconds=" + juce::String(options.seconds),
+        "--min-callbacks=" + juce::String(options.minCallbacks),
+        "--precision=" + juce::String(precision),
+        "--quality=" + juce::String(QUALITY_NAMES[quality - 1]),
+        "--seed=" + juce::String(options.seed),
+    };
+    if (options.impulseResponse != juce::File())
+        command.add("--ir=" + options.impulseResponse.getFullPathName());
+
+    juce::ChildProcess child;
+    if (!child.start(command, juce::ChildProcess::wantStdOut | juce::ChildProcess::wantStdErr)) {
+        error = "could not start worker";
+        return std::nullopt;
+    }
+
+    auto lines = juce::StringArray::fromLines(child.readAllProcessOutput());
+    lines.removeEmptyStrings();
+    error = lines.isEmpty() ? juce::String("no output") : lines[lines.size() - 1];
+
+    if (child.getExitCode() != 0) {
+        error = "exit code " + juce::String(child.getExitCode()) + ": " + error;
+        return std::nullopt;
+    }
+
+    for (auto &line : lines) {
+        if (!line.startsWith(RESULT_PREFIX))
+            continue;
+
+        auto values = juce::StringArray::fromTokens(line.substring((int) std::strlen(RESULT_PREFIX)), " ", "");
+        if (values.size() != 9)
+            break;
+
+        Result result;
+        result.meanMs           = values[0].getDoubleValue();
+        result.p99Ms            = values[1].getDoubleValue();
+        result.p999Ms           = values[2].getDoubleValue();
+        result.maxMs            = values[3].getDoubleValue();
+        result.budgetMs         = values[4].getDoubleValue();
+        result.xrunRate         = values[5].getDoubleValue();
+        result.residentBytes    = (size_t) values[6].getLargeIntValue();
+        result.bytesPerInstance = values[7].getDoubleValue();
+        result.numCallbacks     = values[8].getIntValue();
+        return result;
+    }
+
+    return std::nullopt;
+}
+
+void runSweep(const Options &options, const char *precision) {
+    for (auto quality : options.qualities) {
+        for (auto numInstances : options.instanceCounts) {
+            double baselineMean = 0.0;
+
+            for (auto numThreads : options.threadCounts) {
+                juce::String error;
+                auto         result = runConfiguration(options, precision, quality, numInstances, numThreads, error);
+                if (!result) {
+                    std::printf("%-9s %-7s %9d %7d  failed (%s)\n", precision, QUALITY_NAMES[quality - 1],
+                                numInstances, numThreads, error.toRawUTF8());
+                    std::fflush(stdout);
+                    continue;
+                }
+
+                // Speedup is relative to the first thread count in the sweep
+                if (baselineMean == 0.0)
+                    baselineMean = result->meanMs;
+
+                // Too few callbacks for p99.9 to mean anything, so leave it out rather than repeat the max
+                auto p999 = result->numCallbacks >= P999_MIN_CALLBACKS ? juce::String(result->p999Ms, 3)
+                                                                       : juce::String("-");
+
+                std::printf("%-9s %-7s %9d %7d %8.3f %8.3f %8s %8.3f %7.1f %7.2f %8.1f %8.1f %8.2f\n", precision,
+                            QUALITY_NAMES[quality - 1], numInstances, numThreads, result->meanMs, result->p99Ms,
+                            p999.toRawUTF8(), result->maxMs, 100.0 * result->meanMs / result->budgetMs,
+                            100.0 * result->xrunRate, result->residentBytes / (1024.0 * 1024.0),
+                            result->bytesPerInstance / 1024.0, baselineMean / result->meanMs);
+                std::fflush(stdout);
+            }
+        }
+    }
+}
+} // namespace
+
+//==============================================================================
+int main(int argc, char *argv[]) {
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+    juce::ArgumentList              args(argc, argv);
+
+    if (args.containsOption("--help|-h")) {
+        printUsage();
+        return 0;
+    }
+
+    Options options;
+    options.instanceCounts = parseList(args.getValueForOption("--instances"), options.instanceCounts);
+    options.threadCounts   = parseList(args.getValueForOption("--threads"), options.threadCounts);
+    options.qualities      = parseQualities(args.getValueForOption("--quality"), options.qualities);
+
+    if (args.containsOption("--block"))
+        options.blockSize = juce::jmax(1, args.getValueForOption("--block").getIntValue());
+    if (args.containsOption("--rate"))
+        options.sampleRate = juce::jmax(1.0, args.getValueForOption("--rate").getDoubleValue());
+    if (args.containsOption("--chain"))
+        options.pluginsPerTrack = juce::jmax(1, args.getValueForOption("--chain").getIntValue());
+    if (args.containsOption("--seconds"))
+        options.seconds = juce::jmax(0.1, args.getValueForOption("--seconds").getDoubleValue());
+    if (args.containsOption("--min-callbacks"))
+        options.minCallbacks = juce::jmax(1, args.getValueForOption("--min-callbacks").getIntValue());
+    if (args.containsOption("--seed"))
+        options.seed = args.getValueForOption("--seed").getIntValue();
+
+    if (args.containsOption("--ir")) {
+        options.impulseResponse = args.getFileForOption("--ir");
+        if (!options.impulseResponse.existsAsFile()) {
+            std::fprintf(stderr, "No such impulse response: %s\n", args.getValueForOption("--ir").toRawUTF8());
+            return 1;
+        }
+    }
+
+    if (args.containsOption("--worker"))
+        return runWorker(options, args);
+
+    auto precision    = args.getValueForOption("--precision");
+    options.runFloat  = precision.isEmpty() || precision == "float" || precision == "both";
+    options.runDouble = precision == "double" || precision == "both";
+
+    std::printf("block %d @ %.0f Hz (budget %.3f ms), %d instance(s) per track, at least %d callbacks, IR: %s\n\n",
+                options.blockSize, options.sampleRate, 1000.0 * options.blockSize / options.sampleRate,
+                options.pluginsPerTrack, options.minCallbacks,
+                options.impulseResponse != juce::File() ? options.impulseResponse.getFileName().toRawUTF8() : "none");
+    std::printf("%-9s %-7s %9s %7s %8s %8s %8s %8s %7s %7s %8s %8s %8s\n", "precision", "quality", "instances",
+                "threads", "mean ms", "p99 ms", "p99.9 ms", "max ms", "load %", "xrun %", "RSS MB", "KB/inst",
+                "speedup");
+
+    if (options.runFloat)
+        runSweep(options, "float");
+    if (options.runDouble)
+        runSweep(options, "double");
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+#include "ConvolutionReverb.h"
+#include "ReverbTank.h"
+
+ConvolutionReverb::~ConvolutionReverb() {
+    if (auto *next = pending.exchange(nullptr); next != getUnloadMarker())
+        delete next;
+    delete retired.exchange(nullptr);
+    delete fadingOut;
+    delete active;
+}
+
+void ConvolutionReverb::prepare(const juce::dsp::ProcessSpec &spec) {
+    inputBuffer.setSize(PartitionedConvolver::MAX_CHANNELS, (int) spec.maximumBlockSize);
+    wetBuffer.setSize(PartitionedConvolver::MAX_CHANNELS, (int) spec.maximumBlockSize);
+    fadeBuffer.setSize(PartitionedConvolver::MAX_CHANNELS, (int) spec.maximumBlockSize);
+    fadeLength = juce::jmax(1, juce::roundToInt(CROSSFADE_SECONDS * spec.sampleRate));
+    sampleRate = spec.sampleRate;
+}
+
+void ConvolutionReverb::setMaxLengthSeconds(double seconds) {
+    maxLength = juce::jmax(1, juce::roundToInt(seconds * sampleRate));
+}
+
+PartitionedConvolver *ConvolutionReverb::getUnloadMarker() {
+    static char marker;
+    return reinterpret_cast<PartitionedConvolver *>(&marker);
+}
+
+void ConvolutionReverb::install(std::unique_ptr<PartitionedConvolver> convolver) {
+    auto *next = convolver != nullptr ? convolver.release() : getUnloadMarker();
+
+    // Whatever was still pending was never seen by the audio thread, so it's safe to drop here
+    if (auto *previous = pending.exchange(next); previous != getUnloadMarker())
+        delete previous;
+}
+
+void ConvolutionReverb::releaseRetired() {
+    delete retired.exchange(nullptr);
+}
+
+bool ConvolutionReverb::isHandoverInFlight() const {
+    return pending.load() != nullptr || fadeInProgress.load() || retired.load() != nullptr;
+}
+
+template <typename SampleType>
+bool ConvolutionReverb::process(juce::dsp::AudioBlock<SampleType>       &block,
+                                const juce::dsp::AudioBlock<SampleType> &early, float wetLevel, float dryLevel) {
+    // Only take a new convolver once the loader has collected the last one we retired,
+    // so there is never more than one retiree waiting and nothing gets freed here
+    if (!fading && retired.load() == nullptr) {
+        if (auto *next = pending.exchange(nullptr)) {
+            if (next == getUnloadMarker())
+                next = nullptr;
+
+            // Unloading with nothing loaded has nothing to fade out
+            if (next != nullptr || active != nullptr) {
+                fadingOut    = active;
+                active       = next;
+                fading       = true;
+                fadePosition = 0;
+                fadeInProgress.store(true);
+            }
+        }
+    }
+
+    loaded.store(active != nullptr);
+
+    if ((active == nullptr && !fading) || wetBuffer.getNumSamples() == 0)
+        return false;
+
+    if (active != nullptr)
+        active->setLengthLimit(maxLength);
+    if (fadingOut != nullptr)
+        fadingOut->setLengthLimit(maxLength);
+
+    wetLevel *= ReverbTank<float>::WET_SCALE_FACTOR;
+    dryLevel *= ReverbTank<float>::DRY_SCALE_FACTOR;
+
+    const auto maxChunk = (size_t) wetBuffer.getNumSamples();
+    for (size_t start = 0; start < block.getNumSamples(); start += maxChunk) {
+        auto length     = juce::jmin(maxChunk, block.getNumSamples() - start);
+        auto subBlock   = block.getSubBlock(start, length);
+        auto earlyChunk = early.getSubBlock(start, length);
+        processChunk(subBlock, earlyChunk, wetLevel, dryLevel);
+    }
+
+    return true;
+}
+
+template <typename SampleType>
+void ConvolutionReverb::processChunk(juce::dsp::AudioBlock<SampleType> &block,
+                                     const juce::dsp::AudioBlock<SampleType> &early, float wetLevel, float dryLevel) {
+    auto numSamples  = (int) block.getNumSamples();
+    auto numChannels = juce::jmin((int) block.getNumChannels(), PartitionedConvolver::MAX_CHANNELS);
+
+    // The convolver hears the dry signal with the early reflections on top, like the tank does
+    const float *input[PartitionedConvolver::MAX_CHANNELS] = {};
+    for (int ch = 0; ch < numChannels; ++ch) {
+        auto *src       = block.getChannelPointer((size_t) ch);
+        auto *reflected = early.getChannelPointer((size_t) ch);
+        auto *dst       = inputBuffer.getWritePointer(ch);
+
+        if constexpr (std::is_same_v<SampleType, float>) {
+            juce::FloatVectorOperations::add(dst, src, reflected, numSamples);
+        } else {
+            for (int i = 0; i < numSamples; ++i)
+                dst[i] = (float) (src[i] + reflected[i]);
+        }
+        input[ch] = dst;
+    }
+
+    if (active != nullptr)
+        active->process(input, wetBuffer.getArrayOfWritePointers(), numChannels, numSamples);
+    else
+        wetBuffer.clear();
+
+    if (fading) {
+        if (fadingOut != nullptr)
+            fadingOut->process(input, fadeBuffer.getArrayOfWritePointers(), numChannels, numSamples);
+        else
+            fadeBuffer.clear();
+
+        for (int ch = 0; ch < numChannels; ++ch) {
+            auto *wet = wetBuffer.getWritePointer(ch);
+            auto *old = fadeBuffer.getReadPointer(ch);
+
+            for (int i = 0; i < numSamples; ++i) {
+                auto gain = juce::jmin(1.0f, (float) (fadePosition + i) / (float) fadeLength);
+                wet[i]    = old[i] + gain * (wet[i] - old[i]);
+            }
+        }
+
+        fadePosition += numSamples;
+        if (fadePosition >= fadeLength) {
+            fading = false;
+            retired.store(fadingOut);
+            fadeInProgress.store(false);
+            fadingOut = nullptr;
+        }
+    }
+
+    for (int ch = 0; ch < numChannels; ++ch) {
+        auto *samples   = block.getChannelPointer((size_t) ch);
+        auto *reflected = early.getChannelPointer((size_t) ch);
+        auto *wet       = wetBuffer.getReadPointer(ch);
+
+        if constexpr (std::is_same_v<SampleType, float>) {
+            juce::FloatVectorOperations::multiply(samples, dryLevel, numSamples);
+            juce::FloatVectorOperations::addWithMultiply(samples, wet, wetLevel, numSamples);
+            juce::FloatVectorOperations::addWithMultiply(samples, reflected, wetLevel, numSamples);
+        } else {
+            for (int i = 0; i < numSamples; ++i)
+                samples[i] = samples[i] * dryLevel + ((SampleType) wet[i] + reflected[i]) * wetLevel;
+        }
+    }
+}
+
+template bool ConvolutionReverb::process<float>(juce::dsp::AudioBlock<float> &, const juce::dsp::AudioBlock<float> &,
+                                                float, float);
+template bool ConvolutionReverb::process<double>(juce::dsp::AudioBlock<double> &,
+                                                 const juce::dsp::AudioBlock<double> &, float, float);
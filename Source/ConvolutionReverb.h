@@ -0,0 +1,75 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "PartitionedConvolver.h"
+
+//==============================================================================
+/**
+    Audio-thread side of the IR reverb. New convolvers are handed over through
+    an atomic pointer and crossfaded in, and the one they replace is handed back
+    through a second pointer so it is never freed on the audio thread.
+
+    Installing nothing unloads the IR: the active convolver fades out and is
+    retired the same way, after which process returns false again.
+ */
+class ConvolutionReverb {
+public:
+    ConvolutionReverb() = default;
+    ~ConvolutionReverb();
+
+    void prepare(const juce::dsp::ProcessSpec &spec);
+
+    // Replaces the block with dry + wet convolution; returns false, leaving the block alone, if no IR is loaded.
+    // early holds the block's early reflections: they are convolved along with the dry signal and mixed in at
+    // the wet level. Levels are scaled like the algorithmic tank's, so switching between the two keeps the dry
+    // level. The FFT only runs in single precision, so the convolver always gets a float copy of its input
+    // while the dry signal stays at the block's precision.
+    template <typename SampleType>
+    bool process(juce::dsp::AudioBlock<SampleType> &block, const juce::dsp::AudioBlock<SampleType> &early,
+                 float wetLevel, float dryLevel);
+
+    // True once the audio thread has taken a convolver, until an unload has faded it out
+    bool isLoaded() const { return loaded.load(); }
+
+    // Caps how much of the IR is convolved, from the next hop; the convolvers keep their input history, so the
+    // tail already playing carries on
+    void setMaxLengthSeconds(double seconds);
+
+    //===== Loader thread =====
+
+    // A null convolver unloads the current IR
+    void install(std::unique_ptr<PartitionedConvolver> convolver);
+    void releaseRetired();
+
+    // True from install until the convolver it replaces has been collected by releaseRetired
+    bool isHandoverInFlight() const;
+
+private:
+    inline static constexpr double CROSSFADE_SECONDS = 0.05;
+
+    // Stands in for a null install in pending, which itself means there is nothing to take
+    static PartitionedConvolver *getUnloadMarker();
+
+    template <typename SampleType>
+    void processChunk(juce::dsp::AudioBlock<SampleType> &block, const juce::dsp::AudioBlock<SampleType> &early,
+                      float wetLevel, float dryLevel);
+
+    std::atomic<PartitionedConvolver *> pending{nullptr};
+    std::atomic<PartitionedConvolver *> retired{nullptr};
+    std::atomic<bool>                   fadeInProgress{false};
+    std::atomic<bool>                   loaded{false};
+
+    PartitionedConvolver *active        = nullptr;
+    PartitionedConvolver *fadingOut     = nullptr;
+    bool                  fading        = false;
+    int                   fadePosition  = 0;
+    int                   fadeLength    = 1;
+    double                sampleRate    = 44100.0;
+    int                   maxLength     = std::numeric_limits<int>::max(); // in samples
+
+    juce::AudioBuffer<float> inputBuffer;
+    juce::AudioBuffer<float> wetBuffer;
+    juce::AudioBuffer<float> fadeBuffer;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ConvolutionReverb)
+};
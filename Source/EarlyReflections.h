@@ -0,0 +1,212 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Early reflections ahead of the reverb tail: a single multi-tap delay line
+    per channel whose tap pattern follows ROOM_SIZE and WIDTH.
+
+    The line is stored twice back to back, so every tap reads one contiguous run
+    of samples and is summed with a single vectorised multiply-add.
+
+    The reflections are written to their own block rather than added to the
+    input, so the reverb after them can feed them into its tail and mix them in
+    at the wet level.
+
+    Tap sets are double-buffered: a parameter change builds the new set beside
+    the old one and crossfades between their outputs, so taps never jump.
+ */
+template <typename SampleType> class EarlyReflections {
+public:
+    inline static constexpr int MAX_TAPS = 32;
+
+    EarlyReflections() {
+        juce::Random random(0x45524c);
+
+        for (int k = 0; k < MAX_TAPS; ++k) {
+            // Bit-reversed strata, so a prefix of the table still spans the whole reflection window
+            auto stratum       = reverseTapBits(k);
+            leftPositions[k]   = (stratum + random.nextFloat()) / MAX_TAPS;
+            spreadPositions[k] = (stratum + random.nextFloat()) / MAX_TAPS;
+            polarities[k]      = random.nextBool() ? 1.0f : -1.0f;
+        }
+    }
+
+    void prepare(const juce::dsp::ProcessSpec &spec) {
+        sampleRate   = spec.sampleRate;
+        maxBlockSize = (int) spec.maximumBlockSize;
+
+        maxDelaySamples = (int) std::ceil((PRE_DELAY_MAX + WINDOW_MAX) * sampleRate);
+        lineLength      = juce::nextPowerOfTwo(maxDelaySamples + maxBlockSize);
+
+        delayLine.setSize((int) spec.numChannels, 2 * lineLength);
+        fadeBuffer.setSize((int) spec.numChannels, maxBlockSize);
+        fadeLength = juce::jmax(1, juce::roundToInt(TAP_FADE_SECONDS * sampleRate));
+        reset();
+
+        // Nothing has played through the old taps yet, so the first set goes in without a fade
+        tapsDirty = true;
+        hasTaps   = false;
+        fading    = false;
+    }
+
+    void reset() {
+        delayLine.clear();
+        writePosition = 0;
+    }
+
+    // roomSize, width and level are all normalised to 0..1
+    void setParameters(float newRoomSize, float newWidth, float newLevel) {
+        if (newRoomSize == roomSize && newWidth == width && newLevel == level)
+            return;
+
+        roomSize  = newRoomSize;
+        width     = newWidth;
+        level     = newLevel;
+        tapsDirty = true;
+    }
+
+    void setNumTaps(int newNumTaps) {
+        newNumTaps = juce::jlimit(1, MAX_TAPS, newNumTaps);
+        if (newNumTaps == numTaps)
+            return;
+
+        numTaps   = newNumTaps;
+        tapsDirty = true;
+    }
+
+    // Writes the reflections of input to output, which must be the same length and must not alias it
+    void process(const juce::dsp::AudioBlock<SampleType> &input, juce::dsp::AudioBlock<SampleType> &output) {
+        output.clear();
+        if (lineLength == 0)
+            return;
+
+        // A change that arrives mid-fade waits for the fade to finish, so there are only ever two sets in play
+        if (tapsDirty && !fading)
+            updateTaps();
+
+        for (size_t start = 0; start < input.getNumSamples(); start += (size_t) maxBlockSize) {
+            auto length      = juce::jmin((size_t) maxBlockSize, input.getNumSamples() - start);
+            auto inputChunk  = input.getSubBlock(start, length);
+            auto outputChunk = output.getSubBlock(start, length);
+            processChunk(inputChunk, outputChunk);
+        }
+    }
+
+private:
+    inline static constexpr double PRE_DELAY_MIN = 0.002;
+    inline static constexpr double PRE_DELAY_MAX = 0.012;
+    inline static constexpr double WINDOW_MIN    = 0.010;
+    inline static constexpr double WINDOW_MAX    = 0.070;
+    inline static constexpr float  TAP_DECAY     = 3.0f;
+
+    inline static constexpr double TAP_FADE_SECONDS = 0.01;
+
+    static int reverseTapBits(int k) {
+        int reversed = 0;
+        for (int bit = 1; bit < MAX_TAPS; bit <<= 1, k >>= 1)
+            reversed = (reversed << 1) | (k & 1);
+        return reversed;
+    }
+
+    void updateTaps() {
+        tapsDirty    = false;
+        currentSet   = 1 - currentSet;
+        fading       = hasTaps;
+        fadePosition = 0;
+        hasTaps      = true;
+
+        auto &delays         = tapDelays[currentSet];
+        auto &gains          = tapGains[currentSet];
+        setSizes[currentSet] = numTaps;
+
+        auto preDelay = PRE_DELAY_MIN + roomSize * (PRE_DELAY_MAX - PRE_DELAY_MIN);
+        auto window   = WINDOW_MIN + roomSize * (WINDOW_MAX - WINDOW_MIN);
+        auto norm     = level / std::sqrt((float) numTaps);
+
+        for (int k = 0; k < numTaps; ++k) {
+            // Width 0 gives both channels the same pattern; width 1 gives the right channel its own
+            float positions[2] = {leftPositions[k], juce::jmap(width, leftPositions[k], spreadPositions[k])};
+
+            for (int side = 0; side < 2; ++side) {
+                auto delay      = juce::roundToInt((preDelay + positions[side] * window) * sampleRate);
+                auto gain       = norm * polarities[k] * std::exp(-TAP_DECAY * positions[side]);
+                delays[side][k] = juce::jlimit(0, maxDelaySamples, delay);
+                gains[side][k]  = static_cast<SampleType>(gain);
+            }
+        }
+    }
+
+    void processChunk(const juce::dsp::AudioBlock<SampleType> &input, juce::dsp::AudioBlock<SampleType> &output) {
+        auto numSamples  = (int) input.getNumSamples();
+        auto numChannels = juce::jmin((int) input.getNumChannels(), (int) output.getNumChannels(),
+                                      delayLine.getNumChannels());
+        auto firstPart   = juce::jmin(numSamples, lineLength - writePosition);
+
+        for (int ch = 0; ch < numChannels; ++ch) {
+            auto *samples = input.getChannelPointer((size_t) ch);
+            auto *line    = delayLine.getWritePointer(ch);
+            auto *wet     = output.getChannelPointer((size_t) ch);
+            auto  side    = juce::jmin(ch, 1);
+
+            for (auto *copy : {line, line + lineLength}) {
+                juce::FloatVectorOperations::copy(copy + writePosition, samples, firstPart);
+                juce::FloatVectorOperations::copy(copy, samples + firstPart, numSamples - firstPart);
+            }
+
+            sumTaps(wet, line, currentSet, side, numSamples);
+
+            if (fading) {
+                auto *previous = fadeBuffer.getWritePointer(ch);
+                sumTaps(previous, line, 1 - currentSet, side, numSamples);
+
+                for (int i = 0; i < numSamples; ++i) {
+                    auto gain = juce::jmin(1.0f, (float) (fadePosition + i + 1) / (float) fadeLength);
+                    wet[i]    = previous[i] + static_cast<SampleType>(gain) * (wet[i] - previous[i]);
+                }
+            }
+        }
+
+        writePosition = (writePosition + numSamples) & (lineLength - 1);
+
+        if (fading && (fadePosition += numSamples) >= fadeLength)
+            fading = false;
+    }
+
+    void sumTaps(SampleType *dest, const SampleType *line, int set, int side, int numSamples) const {
+        juce::FloatVectorOperations::clear(dest, numSamples);
+        for (int k = 0; k < setSizes[set]; ++k) {
+            auto readPosition = (writePosition - tapDelays[set][side][k] + lineLength) & (lineLength - 1);
+            juce::FloatVectorOperations::addWithMultiply(dest, line + readPosition, tapGains[set][side][k], numSamples);
+        }
+    }
+
+    float leftPositions[MAX_TAPS];
+    float spreadPositions[MAX_TAPS];
+    float polarities[MAX_TAPS];
+
+    // Two tap sets indexed [set][side][tap]; currentSet is the one playing or fading in
+    int        tapDelays[2][2][MAX_TAPS] = {};
+    SampleType tapGains[2][2][MAX_TAPS]  = {};
+    int        setSizes[2]               = {};
+    int        currentSet                = 0;
+    int        numTaps                   = MAX_TAPS;
+    bool       tapsDirty                 = true;
+    bool       hasTaps                   = false;
+    bool       fading                    = false;
+    int        fadePosition              = 0;
+    int        fadeLength                = 1;
+
+    float roomSize = 0.5f;
+    float width    = 1.0f;
+    float level    = 0.5f;
+
+    double                        sampleRate      = 44100.0;
+    int                           maxBlockSize    = 0;
+    int                           maxDelaySamples = 0;
+    int                           lineLength      = 0;
+    int                           writePosition   = 0;
+    juce::AudioBuffer<SampleType> delayLine;
+    juce::AudioBuffer<SampleType> fadeBuffer;
+};
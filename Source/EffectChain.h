@@ -0,0 +1,149 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ConvolutionReverb.h"
+#include "EarlyReflections.h"
+#include "QualityParams.h"
+#include "ReverbParams.h"
+#include "ReverbTank.h"
+
+enum class QualityTier { eco, normal, high };
+
+//==============================================================================
+/**
+    Filter -> phaser/gain -> early reflections -> reverb, templated on the host's sample type so a
+    64-bit host can run the chain without converting its buffers.
+
+    The reverb stage runs the loaded impulse response when there is one and the
+    comb/all-pass tank otherwise.
+ */
+template <typename SampleType> class EffectChain {
+public:
+    void prepare(const juce::dsp::ProcessSpec &spec, ConvolutionReverb &convolution) {
+        convolutionReverb = &convolution;
+
+        stateVariableFilter.reset();
+        fxChain.reset();
+        stateVariableFilter.prepare(spec);
+        fxChain.prepare(spec);
+        earlyReflections.prepare(spec);
+        reverb.prepare(spec);
+        earlyBuffer.setSize((int) spec.numChannels, (int) spec.maximumBlockSize);
+    }
+
+    void setFilter(int filterChoice, float cutoff) {
+        bypassFilter = false;
+        if (filterChoice == 1)
+            stateVariableFilter.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
+        if (filterChoice == 2)
+            stateVariableFilter.setType(juce::dsp::StateVariableTPTFilterType::bandpass);
+        if (filterChoice == 3)
+            stateVariableFilter.setType(juce::dsp::StateVariableTPTFilterType::highpass);
+        if (filterChoice == 4)
+            bypassFilter = true;
+        stateVariableFilter.setCutoffFrequency(static_cast<SampleType>(cutoff));
+    }
+
+    void setPhaser(bool bypass, float rate, float depth) {
+        bypassPhaser = bypass;
+
+        auto &phaserProcessor = fxChain.template get<phaserIndex>();
+        phaserProcessor.setRate(static_cast<SampleType>(rate));
+        phaserProcessor.setDepth(static_cast<SampleType>(depth));
+    }
+
+    void setGain(float gain) {
+        auto &gainProcessor = fxChain.template get<gainIndex>();
+        gainProcessor.setGainLinear(static_cast<SampleType>(gain));
+    }
+
+    void setReverb(bool bypass, const juce::Reverb::Parameters &params, float earlyLevel, float irLength) {
+        // Nothing ran through the early reflections or the tank while bypassed, so drop what they still hold
+        if (bypassReverb && !bypass) {
+            earlyReflections.reset();
+            reverb.reset();
+        }
+
+        bypassReverb     = bypass;
+        reverbParameters = params;
+        irLengthSeconds  = irLength;
+        earlyReflections.setParameters(params.roomSize, params.width, earlyLevel);
+        reverb.setParameters(params);
+    }
+
+    void process(juce::dsp::AudioBlock<SampleType> &block, QualityTier tier) {
+        juce::dsp::ProcessContextReplacing<SampleType> context(block);
+
+        if (!bypassFilter)
+            stateVariableFilter.process(context);
+        if (!bypassPhaser)
+            fxChain.process(context);
+        if (bypassReverb)
+            return;
+
+        earlyReflections.setNumTaps(getEarlyTaps(tier));
+
+        const auto maxChunk = (size_t) earlyBuffer.getNumSamples();
+        for (size_t start = 0; start < block.getNumSamples(); start += maxChunk) {
+            auto subBlock = block.getSubBlock(start, juce::jmin(maxChunk, block.getNumSamples() - start));
+            processReverb(subBlock, tier);
+        }
+    }
+
+private:
+    static int getEarlyTaps(QualityTier tier) {
+        switch (tier) {
+            case QualityTier::eco:
+                return QualityParams::ECO_EARLY_TAPS;
+            case QualityTier::normal:
+                return QualityParams::NORMAL_EARLY_TAPS;
+            default:
+                return QualityParams::HIGH_EARLY_TAPS;
+        }
+    }
+
+    static double getImpulseResponseSeconds(QualityTier tier) {
+        switch (tier) {
+            case QualityTier::eco:
+                return QualityParams::ECO_IR_SECONDS;
+            case QualityTier::normal:
+                return QualityParams::NORMAL_IR_SECONDS;
+            default:
+                return QualityParams::HIGH_IR_SECONDS;
+        }
+    }
+
+    void processReverb(juce::dsp::AudioBlock<SampleType> &block, QualityTier tier) {
+        // The reflections go to their own block, so the reverb can mix them in at the wet level, not as dry signal
+        juce::dsp::AudioBlock<SampleType> early(earlyBuffer.getArrayOfWritePointers(), block.getNumChannels(),
+                                                block.getNumSamples());
+        earlyReflections.process(block, early);
+
+        if (convolutionReverb != nullptr)
+            convolutionReverb->setMaxLengthSeconds(juce::jmin(getImpulseResponseSeconds(tier), irLengthSeconds));
+
+        if (convolutionReverb != nullptr &&
+            convolutionReverb->process(block, early, reverbParameters.wetLevel, reverbParameters.dryLevel))
+            return;
+
+        // Eco runs one tank on the mid signal and feeds it to both wet outputs; the dry signal stays stereo
+        reverb.setSingleTank(tier == QualityTier::eco);
+        reverb.process(block, early);
+    }
+
+    juce::dsp::StateVariableTPTFilter<SampleType> stateVariableFilter;
+    bool                                          bypassFilter = false;
+
+    enum { phaserIndex, gainIndex };
+    juce::dsp::ProcessorChain<juce::dsp::Phaser<SampleType>, juce::dsp::Gain<SampleType>> fxChain;
+    bool                                                                                  bypassPhaser = false;
+
+    EarlyReflections<SampleType>  earlyReflections;
+    juce::AudioBuffer<SampleType> earlyBuffer;
+
+    ReverbTank<SampleType>   reverb;
+    juce::Reverb::Parameters reverbParameters;
+    double                   irLengthSeconds   = ReverbParams::IR_LENGTH_DEFAULT;
+    ConvolutionReverb       *convolutionReverb = nullptr;
+    bool                     bypassReverb      = false;
+};
@@ -0,0 +1,388 @@
+#include "ImpulseResponseLoader.h"
+#include "ReverbParams.h"
+
+namespace {
+struct CacheHeader {
+    char         magic[8];
+    juce::uint32 version;
+    juce::uint32 partitionSize;
+    juce::uint32 numPartitions;
+    juce::uint32 numChannels;
+    juce::uint64 irHash;
+    double       sampleRate;
+    juce::uint8  reserved[24];
+};
+
+// 64 bytes keeps the partition data behind the header aligned for vector loads
+static_assert(sizeof(CacheHeader) == 64, "CacheHeader layout changed");
+
+constexpr char         CACHE_MAGIC[8] = {'A', '3', 'I', 'R', 'P', 'A', 'R', 'T'};
+constexpr juce::uint32 CACHE_VERSION  = 3; // bump on any decode/resample/normalise change; 3: windowed-sinc
+constexpr int          PAGE_FLOATS    = 4096 / sizeof(float);
+constexpr juce::int64  CACHE_LIMIT    = (juce::int64) 256 << 20; // bytes
+constexpr int          SINC_ZEROS     = 16;                        // zero crossings each side of the kernel
+constexpr int          SINC_STEPS     = 512;                       // kernel table entries per zero crossing
+
+bool hashFileContents(const juce::File &file, juce::uint64 &hash) {
+    juce::FileInputStream in(file);
+    if (!in.openedOk())
+        return false;
+
+    // 64-bit FNV-1a over the raw file bytes
+    constexpr int                chunkSize = 1 << 16;
+    juce::HeapBlock<juce::uint8> chunk(chunkSize);
+    hash = 14695981039346656037ull;
+
+    for (int numRead; (numRead = in.read(chunk, chunkSize)) > 0;)
+        for (int i = 0; i < numRead; ++i)
+            hash = (hash ^ chunk[i]) * 1099511628211ull;
+
+    return true;
+}
+
+juce::String getCacheFileName(juce::uint64 hash, double sampleRate) {
+    return juce::String::toHexString((juce::int64) hash) + "_" + juce::String(juce::roundToInt(sampleRate)) + "_" +
+           juce::String(PartitionedConvolver::PARTITION_SIZE) + ".irp";
+}
+
+// Deletes the least recently used cache files until the rest fit in CACHE_LIMIT; hits refresh the
+// modification time, since access times aren't reliably kept
+void trimCache(const juce::File &keep) {
+    auto files = keep.getParentDirectory().findChildFiles(juce::File::findFiles, false, "*.irp");
+    std::sort(files.begin(), files.end(), [](const juce::File &a, const juce::File &b) {
+        return a.getLastModificationTime() > b.getLastModificationTime();
+    });
+
+    juce::int64 total = 0;
+    for (auto &file : files) {
+        auto size = file.getSize();
+
+        // Deleting can fail where another process still has the file mapped, in which case it stays counted
+        if (file != keep && total + size > CACHE_LIMIT && file.deleteFile())
+            continue;
+        total += size;
+    }
+}
+
+// One side of the Blackman-windowed sinc, indexed by distance from the centre in 1/SINC_STEPS zero crossings,
+// with a trailing zero so interpolating the last entry stays in range
+const std::vector<float> &getSincTable() {
+    static const std::vector<float> table = [] {
+        std::vector<float> values(SINC_ZEROS * SINC_STEPS + 2, 0.0f);
+
+        for (int i = 1; i <= SINC_ZEROS * SINC_STEPS; ++i) {
+            auto phase         = juce::MathConstants<double>::pi * i / SINC_STEPS;
+            auto w             = phase / SINC_ZEROS; // 0 at the centre, pi at the edge
+            auto window        = 0.42 + 0.5 * std::cos(w) + 0.08 * std::cos(2.0 * w);
+            values[(size_t) i] = (float) (std::sin(phase) / phase * window);
+        }
+        values[0] = 1.0f;
+        return values;
+    }();
+    return table;
+}
+
+// Windowed-sinc resampler; ratio is source rate over target rate. The cutoff follows the lower of the two
+// Nyquists, so downsampling filters out what would otherwise alias into the IR
+void resample(const float *source, int sourceLength, float *dest, int destLength, double ratio) {
+    const auto &table     = getSincTable();
+    const auto  cutoff    = 0.5 * juce::jmin(1.0, 1.0 / ratio); // cycles per source sample
+    const auto  halfWidth = SINC_ZEROS / (2.0 * cutoff);         // in source samples
+    const auto  step      = 2.0 * cutoff * SINC_STEPS;           // table entries per source sample
+
+    for (int n = 0; n < destLength; ++n) {
+        auto centre = n * ratio;
+        auto first  = juce::jmax(0, (int) std::ceil(centre - halfWidth));
+        auto last   = juce::jmin(sourceLength - 1, (int) std::floor(centre + halfWidth));
+
+        double sum = 0.0;
+        for (int k = first; k <= last; ++k) {
+            auto position = std::abs(k - centre) * step;
+            auto index    = (int) position;
+            auto fraction = (float) (position - index);
+            sum += source[k] * (table[(size_t) index] + fraction * (table[(size_t) index + 1] - table[(size_t) index]));
+        }
+        dest[n] = (float) (2.0 * cutoff * sum);
+    }
+}
+
+bool writeCacheFile(const juce::File &cacheFile, const CacheHeader &header, const float *partitions,
+                    size_t numFloats) {
+    if (!cacheFile.getParentDirectory().createDirectory().wasOk())
+        return false;
+
+    // Write beside the target and rename, so other instances never map a half-written file
+    juce::TemporaryFile temp(cacheFile);
+    {
+        juce::FileOutputStream out(temp.getFile());
+        if (!out.openedOk() || !out.write(&header, sizeof(header)) ||
+            !out.write(partitions, numFloats * sizeof(float)))
+            return false;
+
+        out.flush();
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
+} // namespace
+
+//==============================================================================
+ImpulseResponseLoaderThread::ImpulseResponseLoaderThread() : juce::Thread("IR Loader") {
+    formatManager.registerBasicFormats();
+    startThread();
+}
+
+ImpulseResponseLoaderThread::~ImpulseResponseLoaderThread() {
+    stopThread(5000);
+}
+
+void ImpulseResponseLoaderThread::add(ImpulseResponseLoader *loader) {
+    const juce::ScopedLock sl(loaderLock);
+    loaders.addIfNotAlreadyThere(loader);
+}
+
+void ImpulseResponseLoaderThread::remove(ImpulseResponseLoader *loader) {
+    {
+        const juce::ScopedLock sl(loaderLock);
+        loaders.removeFirstMatchingValue(loader);
+        if (busyLoader != loader)
+            return;
+    }
+
+    // Only a loader that is being serviced right now has to be waited for, and it was cancelled before removal,
+    // so its build gives up at the next stage
+    for (;;) {
+        loaderIdle.wait(HANDOVER_POLL_MILLISECONDS);
+
+        const juce::ScopedLock sl(loaderLock);
+        if (busyLoader != loader)
+            return;
+    }
+}
+
+void ImpulseResponseLoaderThread::run() {
+    while (!threadShouldExit()) {
+        // Builds run outside the lock, so adding or removing other loaders never waits on them
+        juce::Array<ImpulseResponseLoader *> snapshot;
+        {
+            const juce::ScopedLock sl(loaderLock);
+            snapshot = loaders;
+        }
+
+        bool handoverInFlight = false;
+        for (auto *loader : snapshot) {
+            {
+                const juce::ScopedLock sl(loaderLock);
+                if (!loaders.contains(loader))
+                    continue;
+                busyLoader = loader;
+            }
+
+            handoverInFlight = loader->service() || handoverInFlight;
+
+            {
+                const juce::ScopedLock sl(loaderLock);
+                busyLoader = nullptr;
+            }
+            loaderIdle.signal();
+        }
+
+        // Sleep until the next request, checking back only while a replaced convolver still has to be collected
+        wait(handoverInFlight ? HANDOVER_POLL_MILLISECONDS : -1);
+    }
+}
+
+//==============================================================================
+ImpulseResponseLoader::ImpulseResponseLoader(ConvolutionReverb &targetIn) : target(targetIn) {
+    loaderThread->add(this);
+}
+
+ImpulseResponseLoader::~ImpulseResponseLoader() {
+    cancelled = true;
+    loaderThread->remove(this);
+}
+
+bool ImpulseResponseLoader::shouldStop() const {
+    return cancelled.load() || loaderThread->threadShouldExit();
+}
+
+void ImpulseResponseLoader::setFile(const juce::File &file) {
+    {
+        const juce::ScopedLock sl(requestLock);
+        requestedFile = file;
+    }
+    requestUpdate();
+}
+
+void ImpulseResponseLoader::setSampleRate(double sampleRate) {
+    {
+        const juce::ScopedLock sl(requestLock);
+        requestedSampleRate = sampleRate;
+    }
+    requestUpdate();
+}
+
+void ImpulseResponseLoader::requestUpdate() {
+    updateRequested = true;
+    loaderThread->wake();
+}
+
+juce::File ImpulseResponseLoader::getCacheDirectory() {
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+        .getChildFile("Bitstachio")
+        .getChildFile("ReverbChorusEffects")
+        .getChildFile("IRCache");
+}
+
+bool ImpulseResponseLoader::service() {
+    target.releaseRetired();
+
+    if (updateRequested.exchange(false)) {
+        Request request;
+        {
+            const juce::ScopedLock sl(requestLock);
+            request.file       = requestedFile;
+            request.sampleRate = requestedSampleRate;
+        }
+
+        if (request != loaded && request.file == juce::File()) {
+            // No file unloads the IR and lets the algorithmic reverb take over again
+            if (loaded.file != juce::File())
+                target.install(nullptr);
+            loaded = request;
+        } else if (request != loaded && request.sampleRate > 0.0 && request.file.existsAsFile()) {
+            if (auto convolver = build(request))
+                target.install(std::move(convolver));
+            loaded = request;
+        }
+    }
+
+    return target.isHandoverInFlight();
+}
+
+std::unique_ptr<PartitionedConvolver> ImpulseResponseLoader::build(const Request &request) {
+    // The convolver covers the whole IR; IR_LENGTH and the quality tier cut it short on the audio thread
+    if (auto spectra = loadSpectra(request.file, request.sampleRate))
+        return std::make_unique<PartitionedConvolver>(std::move(spectra));
+    return nullptr;
+}
+
+std::shared_ptr<const PartitionedConvolver::Spectra> ImpulseResponseLoader::loadSpectra(const juce::File &file,
+                                                                                      double sampleRate) {
+    juce::uint64 hash = 0;
+    if (!hashFileContents(file, hash) || shouldStop())
+        return nullptr;
+
+    auto cacheFile = getCacheDirectory().getChildFile(getCacheFileName(hash, sampleRate));
+
+    if (auto mapped = mapCacheFile(cacheFile, hash, sampleRate)) {
+        cacheFile.setLastModificationTime(juce::Time::getCurrentTime());
+        return mapped;
+    }
+
+    juce::AudioBuffer<float> impulseResponse;
+    if (!decode(file, sampleRate, impulseResponse) || shouldStop())
+        return nullptr;
+
+    auto numChannels   = impulseResponse.getNumChannels();
+    auto numPartitions = PartitionedConvolver::getNumPartitions(impulseResponse.getNumSamples());
+    auto numFloats     = (size_t) numChannels * (size_t) numPartitions * PartitionedConvolver::SPECTRUM_FLOATS;
+
+    juce::HeapBlock<float> partitions(numFloats);
+    PartitionedConvolver::transformPartitions(impulseResponse, partitions);
+
+    CacheHeader header{};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version       = CACHE_VERSION;
+    header.partitionSize = PartitionedConvolver::PARTITION_SIZE;
+    header.numPartitions = (juce::uint32) numPartitions;
+    header.numChannels   = (juce::uint32) numChannels;
+    header.irHash        = hash;
+    header.sampleRate    = sampleRate;
+
+    if (writeCacheFile(cacheFile, header, partitions, numFloats)) {
+        trimCache(cacheFile);
+        if (auto mapped = mapCacheFile(cacheFile, hash, sampleRate))
+            return mapped;
+    }
+
+    // The cache isn't writable, so run straight from the partitions we just computed
+    return std::make_shared<const PartitionedConvolver::Spectra>(std::move(partitions), numChannels, numPartitions);
+}
+
+std::shared_ptr<const PartitionedConvolver::Spectra>
+ImpulseResponseLoader::mapCacheFile(const juce::File &cacheFile, juce::uint64 hash, double sampleRate) {
+    if (!cacheFile.existsAsFile())
+        return nullptr;
+
+    auto mapped = std::make_unique<juce::MemoryMappedFile>(cacheFile, juce::MemoryMappedFile::readOnly);
+    if (mapped->getData() == nullptr || mapped->getSize() < sizeof(CacheHeader))
+        return nullptr;
+
+    CacheHeader header;
+    std::memcpy(&header, mapped->getData(), sizeof(header));
+
+    auto numFloats =
+        (size_t) header.numChannels * (size_t) header.numPartitions * PartitionedConvolver::SPECTRUM_FLOATS;
+
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION ||
+        header.partitionSize != PartitionedConvolver::PARTITION_SIZE || header.irHash != hash ||
+        header.sampleRate != sampleRate || header.numChannels < 1 ||
+        header.numChannels > PartitionedConvolver::MAX_CHANNELS || header.numPartitions < 1 ||
+        mapped->getSize() != sizeof(CacheHeader) + numFloats * sizeof(float))
+        return nullptr;
+
+    auto *partitions =
+        reinterpret_cast<const float *>(static_cast<const char *>(mapped->getData()) + sizeof(CacheHeader));
+
+    // Fault every page in here rather than on the audio thread's first pass through the partitions
+    volatile float sink = 0.0f;
+    for (size_t i = 0; i < numFloats; i += PAGE_FLOATS)
+        sink = sink + partitions[i];
+
+    return std::make_shared<const PartitionedConvolver::Spectra>(std::move(mapped), partitions,
+                                                                 (int) header.numChannels,
+                                                                 (int) header.numPartitions);
+}
+
+bool ImpulseResponseLoader::decode(const juce::File &file, double sampleRate,
+                                   juce::AudioBuffer<float> &impulseResponse) {
+    std::unique_ptr<juce::AudioFormatReader> reader(loaderThread->formatManager.createReaderFor(file));
+    if (reader == nullptr || reader->sampleRate <= 0.0 || reader->lengthInSamples <= 0)
+        return false;
+
+    // The cache holds the whole IR_LENGTH range, so decode up to its maximum whatever IR_LENGTH is set to now
+    auto numChannels = juce::jlimit(1, PartitionedConvolver::MAX_CHANNELS, (int) reader->numChannels);
+    auto maxLength   = (juce::int64) std::ceil(ReverbParams::IR_LENGTH_MAX * reader->sampleRate);
+    auto length      = (int) juce::jlimit((juce::int64) 1, reader->lengthInSamples, maxLength);
+
+    juce::AudioBuffer<float> source(numChannels, length);
+    reader->read(&source, 0, length, 0, true, numChannels > 1);
+
+    if (reader->sampleRate == sampleRate) {
+        impulseResponse = std::move(source);
+    } else {
+        auto ratio        = reader->sampleRate / sampleRate;
+        auto resampledLen = juce::jmax(1, (int) std::ceil(length / ratio));
+        impulseResponse.setSize(numChannels, resampledLen);
+
+        for (int ch = 0; ch < numChannels; ++ch) {
+            if (shouldStop())
+                return false;
+            resample(source.getReadPointer(ch), length, impulseResponse.getWritePointer(ch), resampledLen, ratio);
+        }
+    }
+
+    // Normalise the loudest channel to unit energy, so long and short IRs sit at similar levels
+    float energy = 0.0f;
+    for (int ch = 0; ch < numChannels; ++ch) {
+        auto rms = impulseResponse.getRMSLevel(ch, 0, impulseResponse.getNumSamples());
+        energy   = juce::jmax(energy, rms * rms * impulseResponse.getNumSamples());
+    }
+    if (energy > 0.0f)
+        impulseResponse.applyGain(1.0f / std::sqrt(energy));
+
+    return true;
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "ConvolutionReverb.h"
+
+class ImpulseResponseLoader;
+
+//==============================================================================
+/**
+    The one thread, and the one AudioFormatManager, that every
+    ImpulseResponseLoader in the process shares. It sleeps until a loader asks
+    for work, and only wakes on a timer while a replaced convolver is still
+    waiting to be collected from the audio thread.
+ */
+class ImpulseResponseLoaderThread : private juce::Thread {
+public:
+    ImpulseResponseLoaderThread();
+    ~ImpulseResponseLoaderThread() override;
+
+    void add(ImpulseResponseLoader *loader);
+    void remove(ImpulseResponseLoader *loader);
+    void wake() { notify(); }
+
+    using juce::Thread::threadShouldExit;
+
+    juce::AudioFormatManager formatManager; // only used on this thread
+
+private:
+    inline static constexpr int HANDOVER_POLL_MILLISECONDS = 50;
+
+    void run() override;
+
+    juce::CriticalSection                loaderLock;
+    juce::Array<ImpulseResponseLoader *> loaders;
+    ImpulseResponseLoader               *busyLoader = nullptr; // the one being serviced outside the lock
+    juce::WaitableEvent                  loaderIdle;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ImpulseResponseLoaderThread)
+};
+
+//==============================================================================
+/**
+    Decodes and partitions impulse responses on the shared loader thread and
+    installs them into a ConvolutionReverb. Requests come from setFile and
+    setSampleRate; setting an empty file unloads the IR.
+
+    Partitions are cached on disk for the whole IR_LENGTH range, keyed by the IR
+    file's content hash, the sample rate and the partition size; the least
+    recently used files are evicted past a size limit. A cache hit is
+    memory-mapped and used in place, with no decode or FFT. IR_LENGTH is applied
+    on the audio thread as a limit on the live convolver, so it never rebuilds.
+ */
+class ImpulseResponseLoader {
+public:
+    explicit ImpulseResponseLoader(ConvolutionReverb &target);
+    ~ImpulseResponseLoader();
+
+    void setFile(const juce::File &file);
+    void setSampleRate(double sampleRate);
+
+    static juce::File getCacheDirectory();
+
+private:
+    friend class ImpulseResponseLoaderThread;
+
+    struct Request {
+        juce::File file;
+        double     sampleRate = 0.0;
+
+        bool operator==(const Request &other) const { return file == other.file && sampleRate == other.sampleRate; }
+        bool operator!=(const Request &other) const { return !(*this == other); }
+    };
+
+    // Never called from the audio thread: waking the loader takes the thread's event lock
+    void requestUpdate();
+
+    // Runs on the loader thread; returns true while a convolver handover is still in flight
+    bool service();
+    bool shouldStop() const;
+
+    std::unique_ptr<PartitionedConvolver>                build(const Request &request);
+    std::shared_ptr<const PartitionedConvolver::Spectra> loadSpectra(const juce::File &file, double sampleRate);
+    std::shared_ptr<const PartitionedConvolver::Spectra> mapCacheFile(const juce::File &cacheFile, juce::uint64 hash,
+                                                                      double sampleRate);
+    bool decode(const juce::File &file, double sampleRate, juce::AudioBuffer<float> &impulseResponse);
+
+    ConvolutionReverb                                       &target;
+    juce::SharedResourcePointer<ImpulseResponseLoaderThread> loaderThread;
+
+    juce::CriticalSection requestLock;
+    juce::File            requestedFile;
+    double                requestedSampleRate = 0.0;
+    std::atomic<bool>     updateRequested{false};
+    std::atomic<bool>     cancelled{false};
+
+    Request loaded; // loader thread only
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ImpulseResponseLoader)
+};
@@ -0,0 +1,197 @@
+#include "PartitionedConvolver.h"
+
+int PartitionedConvolver::getNumPartitions(int impulseResponseLength) {
+    return juce::jmax(1, (impulseResponseLength + PARTITION_SIZE - 1) / PARTITION_SIZE);
+}
+
+void PartitionedConvolver::transformPartitions(const juce::AudioBuffer<float> &impulseResponse, float *destination) {
+    juce::dsp::FFT         transform(FFT_ORDER);
+    juce::HeapBlock<float> buffer(2 * FFT_SIZE);
+
+    auto length          = impulseResponse.getNumSamples();
+    auto partitionsPerCh = getNumPartitions(length);
+
+    for (int ch = 0; ch < impulseResponse.getNumChannels(); ++ch) {
+        for (int p = 0; p < partitionsPerCh; ++p) {
+            auto start      = p * PARTITION_SIZE;
+            auto numSamples = juce::jmin(PARTITION_SIZE, length - start);
+
+            juce::FloatVectorOperations::clear(buffer, 2 * FFT_SIZE);
+            if (numSamples > 0)
+                juce::FloatVectorOperations::copy(buffer, impulseResponse.getReadPointer(ch, start), numSamples);
+
+            transform.performRealOnlyForwardTransform(buffer, true);
+            splitSpectrum(buffer, destination);
+            destination += SPECTRUM_FLOATS;
+        }
+    }
+}
+
+void PartitionedConvolver::splitSpectrum(const float *interleaved, float *split) {
+    for (int bin = 0; bin < NUM_BINS; ++bin) {
+        split[bin]            = interleaved[2 * bin];
+        split[NUM_BINS + bin] = interleaved[2 * bin + 1];
+    }
+}
+
+void PartitionedConvolver::interleaveSpectrum(const float *split, float *interleaved) {
+    // Fills the whole FFT_SIZE spectrum, rebuilding the negative frequencies from the positive ones
+    for (int bin = 0; bin < NUM_BINS; ++bin) {
+        interleaved[2 * bin]     = split[bin];
+        interleaved[2 * bin + 1] = split[NUM_BINS + bin];
+    }
+    for (int bin = NUM_BINS; bin < FFT_SIZE; ++bin) {
+        interleaved[2 * bin]     = interleaved[2 * (FFT_SIZE - bin)];
+        interleaved[2 * bin + 1] = -interleaved[2 * (FFT_SIZE - bin) + 1];
+    }
+}
+
+//==============================================================================
+PartitionedConvolver::Spectra::Spectra(std::unique_ptr<juce::MemoryMappedFile> file, const float *dataIn,
+                                       int numChannelsIn, int numPartitionsIn)
+    : mappedFile(std::move(file)), data(dataIn), numChannels(numChannelsIn), numPartitions(numPartitionsIn) {}
+
+PartitionedConvolver::Spectra::Spectra(juce::HeapBlock<float> dataIn, int numChannelsIn, int numPartitionsIn)
+    : ownedData(std::move(dataIn)), data(ownedData.get()), numChannels(numChannelsIn),
+      numPartitions(numPartitionsIn) {}
+
+//==============================================================================
+PartitionedConvolver::PartitionedConvolver(std::shared_ptr<const Spectra> spectraIn)
+    : spectra(std::move(spectraIn)), numPartitions(spectra->numPartitions) {
+    inputHistory.setSize(MAX_CHANNELS, FFT_SIZE);
+    outputSegments.setSize(MAX_CHANNELS, PARTITION_SIZE);
+    frequencyDelayLine.setSize(MAX_CHANNELS, numPartitions * SPECTRUM_FLOATS);
+    accumulators.setSize(MAX_CHANNELS, SPECTRUM_FLOATS);
+    trimmedPartitions.setSize(spectra->numChannels, SPECTRUM_FLOATS);
+    fftBuffer.allocate(2 * FFT_SIZE, true);
+
+    reset();
+}
+
+void PartitionedConvolver::applyLengthLimit() {
+    auto length      = juce::jmin(lengthLimit, numPartitions * PARTITION_SIZE);
+    activePartitions = getNumPartitions(length);
+
+    auto samplesInLastPartition = length - (activePartitions - 1) * PARTITION_SIZE;
+    if (samplesInLastPartition == PARTITION_SIZE)
+        trimmedPartition = -1;
+    else if (activePartitions - 1 != trimmedPartition || samplesInLastPartition != trimmedLength)
+        trimPartition(activePartitions - 1, samplesInLastPartition);
+}
+
+void PartitionedConvolver::trimPartition(int partition, int samplesToKeep) {
+    for (int ch = 0; ch < spectra->numChannels; ++ch) {
+        // Back to the time domain, where the partition is PARTITION_SIZE samples followed by zero padding
+        interleaveSpectrum(getStoredPartition(ch, partition), fftBuffer);
+        fft.performRealOnlyInverseTransform(fftBuffer);
+
+        juce::FloatVectorOperations::clear(fftBuffer + samplesToKeep, 2 * FFT_SIZE - samplesToKeep);
+        fft.performRealOnlyForwardTransform(fftBuffer, true);
+        splitSpectrum(fftBuffer, trimmedPartitions.getWritePointer(ch));
+    }
+
+    trimmedPartition = partition;
+    trimmedLength    = samplesToKeep;
+}
+
+const float *PartitionedConvolver::getStoredPartition(int channel, int partition) const {
+    return spectra->data + ((size_t) channel * (size_t) spectra->numPartitions + (size_t) partition) * SPECTRUM_FLOATS;
+}
+
+const float *PartitionedConvolver::getPartition(int channel, int partition) const {
+    channel = juce::jmin(channel, spectra->numChannels - 1);
+
+    if (partition == trimmedPartition)
+        return trimmedPartitions.getReadPointer(channel);
+    return getStoredPartition(channel, partition);
+}
+
+void PartitionedConvolver::reset() {
+    inputHistory.clear();
+    outputSegments.clear();
+    frequencyDelayLine.clear();
+    accumulators.clear();
+    fifoPosition   = 0;
+    currentSegment = 0;
+    partitionsDone = 1;
+    applyLengthLimit();
+}
+
+void PartitionedConvolver::process(const float *const *input, float *const *output, int numChannels,
+                                   int numSamples) {
+    numChannels = juce::jmin(numChannels, MAX_CHANNELS);
+
+    for (int done = 0; done < numSamples;) {
+        auto count = juce::jmin(numSamples - done, PARTITION_SIZE - fifoPosition);
+
+        for (int ch = 0; ch < numChannels; ++ch) {
+            juce::FloatVectorOperations::copy(inputHistory.getWritePointer(ch, PARTITION_SIZE + fifoPosition),
+                                              input[ch] + done, count);
+            juce::FloatVectorOperations::copy(output[ch] + done, outputSegments.getReadPointer(ch, fifoPosition),
+                                              count);
+        }
+
+        done += count;
+        fifoPosition += count;
+
+        // Keep the tail sum in step with the hop, so the work is spread evenly over the callbacks that fill it
+        auto target = 1 + (activePartitions - 1) * fifoPosition / PARTITION_SIZE;
+        for (int ch = 0; ch < numChannels; ++ch)
+            accumulateTail(ch, partitionsDone, target);
+        partitionsDone = target;
+
+        if (fifoPosition == PARTITION_SIZE) {
+            for (int ch = 0; ch < numChannels; ++ch)
+                processPartition(ch);
+
+            currentSegment = (currentSegment + 1) % numPartitions;
+            fifoPosition   = 0;
+            partitionsDone = 1;
+            applyLengthLimit();
+        }
+    }
+}
+
+void PartitionedConvolver::multiplyAccumulate(float *accumulator, const float *x, const float *h) {
+    // (xr + i xi)(hr + i hi) = (xr hr - xi hi) + i (xr hi + xi hr)
+    juce::FloatVectorOperations::addWithMultiply(accumulator, x, h, NUM_BINS);
+    juce::FloatVectorOperations::subtractWithMultiply(accumulator, x + NUM_BINS, h + NUM_BINS, NUM_BINS);
+    juce::FloatVectorOperations::addWithMultiply(accumulator + NUM_BINS, x, h + NUM_BINS, NUM_BINS);
+    juce::FloatVectorOperations::addWithMultiply(accumulator + NUM_BINS, x + NUM_BINS, h, NUM_BINS);
+}
+
+void PartitionedConvolver::accumulateTail(int channel, int firstPartition, int endPartition) {
+    // currentSegment is where the hop being filled will land, so partition p pairs with the input from p hops back
+    auto *delayLine   = frequencyDelayLine.getReadPointer(channel);
+    auto *accumulator = accumulators.getWritePointer(channel);
+
+    for (int p = firstPartition; p < endPartition; ++p) {
+        auto segment = (currentSegment - p + numPartitions) % numPartitions;
+        multiplyAccumulate(accumulator, delayLine + segment * SPECTRUM_FLOATS, getPartition(channel, p));
+    }
+}
+
+void PartitionedConvolver::processPartition(int channel) {
+    auto *history = inputHistory.getWritePointer(channel);
+
+    // Spectrum of the newest two partitions of input goes into the frequency-domain delay line
+    juce::FloatVectorOperations::copy(fftBuffer, history, FFT_SIZE);
+    juce::FloatVectorOperations::clear(fftBuffer + FFT_SIZE, FFT_SIZE);
+    fft.performRealOnlyForwardTransform(fftBuffer, true);
+
+    auto *spectrum = frequencyDelayLine.getWritePointer(channel, currentSegment * SPECTRUM_FLOATS);
+    splitSpectrum(fftBuffer, spectrum);
+
+    // The older partitions are already summed, so only the newest input against partition 0 is left
+    auto *accumulator = accumulators.getWritePointer(channel);
+    multiplyAccumulate(accumulator, spectrum, getPartition(channel, 0));
+
+    // Keep the second half of the inverse (overlap-save)
+    interleaveSpectrum(accumulator, fftBuffer);
+    fft.performRealOnlyInverseTransform(fftBuffer);
+    juce::FloatVectorOperations::clear(accumulator, SPECTRUM_FLOATS);
+
+    juce::FloatVectorOperations::copy(outputSegments.getWritePointer(channel), fftBuffer + PARTITION_SIZE,
+                                      PARTITION_SIZE);
+    juce::FloatVectorOperations::copy(history, history + PARTITION_SIZE, PARTITION_SIZE);
+}
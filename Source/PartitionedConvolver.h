@@ -0,0 +1,94 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Uniformly partitioned overlap-save convolution against an impulse response
+    that has already been transformed into the frequency domain.
+
+    The partitions are only read, never copied, so they can live in a
+    memory-mapped cache file shared by every convolver built from the same IR.
+    Everything the audio thread touches is allocated in the constructor, which
+    runs on the loader thread. Output is delayed by PARTITION_SIZE samples.
+
+    Spectra are stored split, NUM_BINS real parts then NUM_BINS imaginary
+    parts, so the complex multiply-adds run as vectorised float operations.
+    Partitions 1 and up only need input that has already arrived, so they are
+    accumulated a slice at a time as each hop fills; the callback that
+    completes a hop only does partition 0 and the FFT pair.
+ */
+class PartitionedConvolver {
+public:
+    inline static constexpr int PARTITION_SIZE  = 512;
+    inline static constexpr int FFT_ORDER       = 10; // FFT size is 2 * PARTITION_SIZE
+    inline static constexpr int FFT_SIZE        = 1 << FFT_ORDER;
+    inline static constexpr int NUM_BINS        = PARTITION_SIZE + 1;
+    inline static constexpr int SPECTRUM_FLOATS = NUM_BINS * 2;
+    inline static constexpr int MAX_CHANNELS    = 2;
+
+    static int getNumPartitions(int impulseResponseLength);
+
+    // Writes numChannels * numPartitions spectra of SPECTRUM_FLOATS floats each, channel-major
+    static void transformPartitions(const juce::AudioBuffer<float> &impulseResponse, float *destination);
+
+    // A full-length IR's partition spectra, memory-mapped from the cache or held in memory
+    struct Spectra {
+        Spectra(std::unique_ptr<juce::MemoryMappedFile> mappedFile, const float *data, int numChannels,
+                int numPartitions);
+        Spectra(juce::HeapBlock<float> data, int numChannels, int numPartitions);
+
+        std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+        juce::HeapBlock<float>                  ownedData;
+        const float                            *data;
+        int                                     numChannels;
+        int                                     numPartitions;
+
+        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(Spectra)
+    };
+
+    // Input history is kept for the whole IR, so the length limit can move without losing the tail in flight
+    explicit PartitionedConvolver(std::shared_ptr<const Spectra> spectra);
+
+    // Convolves up to MAX_CHANNELS input channels into output; input and output must not alias
+    void process(const float *const *input, float *const *output, int numChannels, int numSamples);
+    void reset();
+
+    // Convolves only the first maxSamples of the IR from the next hop on. Whole partitions are read from the
+    // spectra; the one the cut falls in is transformed again with its tail zeroed, which costs an FFT pair per
+    // channel on the hop where the cut moves. Safe to call from the audio thread.
+    void setLengthLimit(int maxSamples) { lengthLimit = juce::jmax(1, maxSamples); }
+
+private:
+    void         applyLengthLimit();
+    void         trimPartition(int partition, int samplesToKeep);
+    const float *getStoredPartition(int channel, int partition) const;
+    const float *getPartition(int channel, int partition) const;
+    void        accumulateTail(int channel, int firstPartition, int endPartition);
+    void        processPartition(int channel);
+
+    static void multiplyAccumulate(float *accumulator, const float *x, const float *h);
+    static void splitSpectrum(const float *interleaved, float *split);
+    static void interleaveSpectrum(const float *split, float *interleaved);
+
+    std::shared_ptr<const Spectra> spectra;
+    int                            numPartitions;
+    int                            trimmedPartition = -1; // index of the partition the cut falls in, if any
+    int                            trimmedLength    = 0;
+    juce::AudioBuffer<float>       trimmedPartitions; // that partition with its tail zeroed, per impulse channel
+
+    juce::dsp::FFT fft{FFT_ORDER};
+
+    juce::AudioBuffer<float> inputHistory;       // last FFT_SIZE input samples per channel
+    juce::AudioBuffer<float> outputSegments;     // last PARTITION_SIZE output samples per channel
+    juce::AudioBuffer<float> frequencyDelayLine; // numPartitions input spectra per channel
+    juce::AudioBuffer<float> accumulators;       // partial sum for the hop being filled, per channel
+    juce::HeapBlock<float>   fftBuffer;
+    int                      fifoPosition     = 0;
+    int                      currentSegment   = 0;
+    int                      partitionsDone   = 1;
+    int                      activePartitions = 1;
+    int                      lengthLimit      = std::numeric_limits<int>::max();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PartitionedConvolver)
+};
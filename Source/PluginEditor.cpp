@@ -11,6 +11,7 @@
 
 #include "ReverbParams.h"
 #include "ChorusParams.h"
+#include "QualityParams.h"
 
 //===== Component Initializers =====
 
@@ -84,6 +85,20 @@ A3AudioProcessorEditor::A3AudioProcessorEditor(A3AudioProcessor &p) : AudioProce
     phaserMenu.addItem("Phaser: Off", 2);
     addAndMakeVisible(&phaserMenu);
 
+    qualityMenu.setJustificationType(juce::Justification::centred);
+    qualityMenu.addItem("Quality: Eco", QualityParams::ECO);
+    qualityMenu.addItem("Quality: Normal", QualityParams::NORMAL);
+    qualityMenu.addItem("Quality: High", QualityParams::HIGH);
+    qualityMenu.addItem("Quality: Auto", QualityParams::AUTO);
+    addAndMakeVisible(&qualityMenu);
+
+    // Shows the tier actually running, which is what Auto has picked when the menu says Auto
+    activeQualityLabel.setJustificationType(juce::Justification::centred);
+    activeQualityLabel.setColour(juce::Label::textColourId, palette.text);
+    addAndMakeVisible(&activeQualityLabel);
+    timerCallback();
+    startTimerHz(10);
+
     cutOffSlider.setSliderStyle(juce::Slider::SliderStyle::RotaryVerticalDrag);
     cutOffSlider.setTextBoxStyle(juce::Slider::NoTextBox, false, 0, 0);
     cutOffSlider.setPopupDisplayEnabled(true, true, this);
@@ -116,6 +131,8 @@ A3AudioProcessorEditor::A3AudioProcessorEditor(A3AudioProcessor &p) : AudioProce
         audioProcessor.apvts, "FILTERMENU", filterMenu);
     phaserMenuValue = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
         audioProcessor.apvts, "PHASERMENU", phaserMenu);
+    qualityMenuValue = std::make_unique<juce::AudioProcessorValueTreeState::ComboBoxAttachment>(
+        audioProcessor.apvts, "QUALITY", qualityMenu);
 
     // Reverb parameters
     initToggleButton(reverbBypassToggle, reverbBypassAttachment, "REVERB_BYPASS", "Reverb Bypass", palette.buttonOff,
@@ -135,6 +152,33 @@ A3AudioProcessorEditor::A3AudioProcessorEditor(A3AudioProcessor &p) : AudioProce
     initSlider(*this, reverbDryLevelLabel, reverbDryLevelUnitLabel, reverbDryLevelSlider, reverbDryLevelAttachment,
                audioProcessor.apvts, "DRY_LEVEL", "Dry Level", "[ % ]", ReverbParams::DRY_MIN, ReverbParams::DRY_MAX,
                ReverbParams::DRY_STEP, palette);
+    initSlider(*this, reverbEarlyLevelLabel, reverbEarlyLevelUnitLabel, reverbEarlyLevelSlider,
+               reverbEarlyLevelAttachment, audioProcessor.apvts, "EARLY_LEVEL", "Early Level", "[ % ]",
+               ReverbParams::EARLY_MIN, ReverbParams::EARLY_MAX, ReverbParams::EARLY_STEP, palette);
+    initSlider(*this, reverbIRLengthLabel, reverbIRLengthUnitLabel, reverbIRLengthSlider, reverbIRLengthAttachment,
+               audioProcessor.apvts, "IR_LENGTH", "IR Length", "[ s ]", ReverbParams::IR_LENGTH_MIN,
+               ReverbParams::IR_LENGTH_MAX, ReverbParams::IR_LENGTH_STEP, palette);
+
+    loadIRButton.setButtonText("Load IR...");
+    loadIRButton.setColour(juce::TextButton::buttonColourId, palette.buttonOff);
+    loadIRButton.setColour(juce::TextButton::textColourOffId, palette.text);
+    loadIRButton.onClick = [this]() {
+        irFileChooser = std::make_unique<juce::FileChooser>("Select an impulse response", juce::File(),
+                                                            "*.wav;*.aif;*.aiff;*.flac");
+        irFileChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles,
+                                   [this](const juce::FileChooser &chooser) {
+                                       auto file = chooser.getResult();
+                                       if (file.existsAsFile())
+                                           audioProcessor.loadImpulseResponse(file);
+                                   });
+    };
+    addAndMakeVisible(&loadIRButton);
+
+    clearIRButton.setButtonText("Clear IR");
+    clearIRButton.setColour(juce::TextButton::buttonColourId, palette.buttonOff);
+    clearIRButton.setColour(juce::TextButton::textColourOffId, palette.text);
+    clearIRButton.onClick = [this]() { audioProcessor.clearImpulseResponse(); };
+    addAndMakeVisible(&clearIRButton);
     initToggleButton(reverbFreezeModeToggle, reverbFreezeModeAttachment, "FREEZE_MODE", "Freeze Mode",
                      palette.buttonOff, palette.buttonOn, palette.text);
 
@@ -160,6 +204,20 @@ A3AudioProcessorEditor::A3AudioProcessorEditor(A3AudioProcessor &p) : AudioProce
 
 A3AudioProcessorEditor::~A3AudioProcessorEditor() {}
 
+void A3AudioProcessorEditor::timerCallback() {
+    switch (audioProcessor.getActiveQualityTier()) {
+        case QualityTier::eco:
+            activeQualityLabel.setText("Running: Eco", juce::dontSendNotification);
+            break;
+        case QualityTier::normal:
+            activeQualityLabel.setText("Running: Normal", juce::dontSendNotification);
+            break;
+        case QualityTier::high:
+            activeQualityLabel.setText("Running: High", juce::dontSendNotification);
+            break;
+    }
+}
+
 //==============================================================================
 void A3AudioProcessorEditor::paint(juce::Graphics &g) {
     g.fillAll(palette.background);
@@ -177,6 +235,9 @@ void A3AudioProcessorEditor::resized() {
     depthSlider.setBounds(209, 90, 70, 150);
     gainSlider.setBounds(295, 90, 70, 150);
 
+    qualityMenu.setBounds(30, 260, 200, 20);
+    activeQualityLabel.setBounds(240, 260, 110, 20);
+
     //----- Reverb Parameters -----
 
     reverbRoomSizeLabel.setBounds(600, 60, 250, 30);
@@ -199,5 +260,15 @@ void A3AudioProcessorEditor::resized() {
     reverbDryLevelSlider.setBounds(600, 330, 250, 20);
     reverbDryLevelUnitLabel.setBounds(860, 330, 40, 20);
 
-    reverbBypassToggle.setBounds(600, 380, 140, 60);
+    reverbEarlyLevelLabel.setBounds(600, 360, 250, 30);
+    reverbEarlyLevelSlider.setBounds(600, 390, 250, 20);
+    reverbEarlyLevelUnitLabel.setBounds(860, 390, 40, 20);
+
+    reverbIRLengthLabel.setBounds(600, 420, 250, 30);
+    reverbIRLengthSlider.setBounds(600, 450, 250, 20);
+    reverbIRLengthUnitLabel.setBounds(860, 450, 40, 20);
+
+    reverbBypassToggle.setBounds(600, 500, 140, 60);
+    loadIRButton.setBounds(760, 500, 140, 28);
+    clearIRButton.setBounds(760, 532, 140, 28);
 }
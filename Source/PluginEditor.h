@@ -14,7 +14,7 @@
 //==============================================================================
 /**
  */
-class A3AudioProcessorEditor : public juce::AudioProcessorEditor {
+class A3AudioProcessorEditor : public juce::AudioProcessorEditor, private juce::Timer {
 public:
     A3AudioProcessorEditor(A3AudioProcessor &);
     ~A3AudioProcessorEditor() override;
@@ -24,6 +24,8 @@ public:
     void resized() override;
 
 private:
+    void timerCallback() override;
+
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     A3AudioProcessor &audioProcessor;
@@ -45,6 +47,8 @@ private:
     juce::Slider   gainSlider;
     juce::ComboBox filterMenu;
     juce::ComboBox phaserMenu;
+    juce::ComboBox qualityMenu;
+    juce::Label    activeQualityLabel;
 
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>   cutOffValue;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>   rateValue;
@@ -52,6 +56,7 @@ private:
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment>   gainValue;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> filterMenuValue;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> phaserMenuValue;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::ComboBoxAttachment> qualityMenuValue;
 
     //===== Component Initializers =====
 
@@ -102,6 +107,23 @@ private:
     juce::Slider                                                          reverbDryLevelSlider;
     std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> reverbDryLevelAttachment;
 
+    // Early Level
+    juce::Label                                                           reverbEarlyLevelLabel;
+    juce::Label                                                           reverbEarlyLevelUnitLabel;
+    juce::Slider                                                          reverbEarlyLevelSlider;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> reverbEarlyLevelAttachment;
+
+    // IR Length
+    juce::Label                                                           reverbIRLengthLabel;
+    juce::Label                                                           reverbIRLengthUnitLabel;
+    juce::Slider                                                          reverbIRLengthSlider;
+    std::unique_ptr<juce::AudioProcessorValueTreeState::SliderAttachment> reverbIRLengthAttachment;
+
+    // Impulse Response File
+    juce::TextButton                   loadIRButton;
+    juce::TextButton                   clearIRButton;
+    std::unique_ptr<juce::FileChooser> irFileChooser;
+
     // Freeze Mode
     juce::TextButton                                                      reverbFreezeModeToggle;
     std::unique_ptr<juce::AudioProcessorValueTreeState::ButtonAttachment> reverbFreezeModeAttachment;
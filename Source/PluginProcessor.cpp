@@ -11,6 +11,23 @@
 
 #include "ReverbParams.h"
 #include "ChorusParams.h"
+#include "QualityParams.h"
+
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+#include <time.h>
+#endif
+
+namespace {
+// CPU time used by the calling thread, in seconds, or -1 where the platform has no precise per-thread clock
+double getThreadCpuSeconds() {
+#if JUCE_LINUX || JUCE_MAC || JUCE_BSD
+    timespec now;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now) == 0)
+        return (double) now.tv_sec + (double) now.tv_nsec * 1.0e-9;
+#endif
+    return -1.0;
+}
+} // namespace
 
 //==============================================================================
 A3AudioProcessor::A3AudioProcessor()
@@ -23,12 +40,16 @@ A3AudioProcessor::A3AudioProcessor()
                          .withOutput("Output", juce::AudioChannelSet::stereo(), true)
 #endif
                          ),
-      apvts(*this, nullptr, "PARAMETERS", createParameterLayout())
+      apvts(*this, nullptr, "PARAMETERS", createParameterLayout()),
+      impulseResponseLoader(convolutionReverb)
 #endif
 {
+    ++liveInstances;
 }
 
-A3AudioProcessor::~A3AudioProcessor() {}
+A3AudioProcessor::~A3AudioProcessor() {
+    --liveInstances;
+}
 
 //==============================================================================
 const juce::String A3AudioProcessor::getName() const {
@@ -88,14 +109,33 @@ void A3AudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock) {
     spec.maximumBlockSize = samplesPerBlock;
     spec.numChannels      = getMainBusNumOutputChannels();
 
-    stateVariableFilter.reset();
-    fxChain.reset();
-    stateVariableFilter.prepare(spec);
-    fxChain.prepare(spec);
-    updateFX();
+    convolutionReverb.prepare(spec);
+    impulseResponseLoader.setSampleRate(sampleRate);
+
+    if (isUsingDoublePrecision())
+        prepareChain(doubleChain, spec);
+    else
+        prepareChain(floatChain, spec);
+
+    numCpus                    = juce::SystemStats::getNumCpus();
+    averageLoad                = 0.0;
+    averageInterval            = 1.0;
+    blocksBelowStepUpLoad      = 0;
+    blocksOverSpikeLoad        = 0;
+    blocksSinceParameterUpdate = 0;
+    lastBlockSamples           = 0;
+    lastCallbackTicks          = 0;
+    updateQualityTier(0, 0, 0.0);
 }
 
-void A3AudioProcessor::updateFX() {
+template <typename SampleType>
+void A3AudioProcessor::prepareChain(EffectChain<SampleType> &chain, const juce::dsp::ProcessSpec &spec) {
+    chain.prepare(spec, convolutionReverb);
+    updateFX(chain);
+    updateReverb(chain);
+}
+
+template <typename SampleType> void A3AudioProcessor::updateFX(EffectChain<SampleType> &chain) {
     int   filterChoice = *apvts.getRawParameterValue("FILTERMENU");
     int   phaserChoice = *apvts.getRawParameterValue("PHASERMENU");
     float cutoff       = *apvts.getRawParameterValue("CUTOFF");
@@ -103,34 +143,15 @@ void A3AudioProcessor::updateFX() {
     float phaserDepth  = *apvts.getRawParameterValue("PHASERDEPTH");
     float gain         = *apvts.getRawParameterValue("GAIN");
 
-    bypassFilter = false;
-    if (filterChoice == 1)
-        stateVariableFilter.setType(juce::dsp::StateVariableTPTFilterType::lowpass);
-    if (filterChoice == 2)
-        stateVariableFilter.setType(juce::dsp::StateVariableTPTFilterType::bandpass);
-    if (filterChoice == 3)
-        stateVariableFilter.setType(juce::dsp::StateVariableTPTFilterType::highpass);
-    if (filterChoice == 4)
-        bypassFilter = true;
-    stateVariableFilter.setCutoffFrequency(cutoff);
-
-    if (phaserChoice == 1)
-        bypassPhaser = false;
-    if (phaserChoice == 2)
-        bypassPhaser = true;
-
-    auto &gainProcessor = fxChain.template get<gainIndex>();
-    gainProcessor.setGainLinear(gain);
-
-    auto &phaserProcessor = fxChain.template get<phaserIndex>();
-    phaserProcessor.setRate(phaserRate);
-    phaserProcessor.setDepth(phaserDepth);
+    chain.setFilter(filterChoice, cutoff);
+    chain.setPhaser(phaserChoice == 2, phaserRate, phaserDepth);
+    chain.setGain(gain);
 }
 
-void A3AudioProcessor::updateReverb() {
-    bypassReverb = apvts.getRawParameterValue("REVERB_BYPASS")->load();
+template <typename SampleType> void A3AudioProcessor::updateReverb(EffectChain<SampleType> &chain) {
+    bool bypassReverb = apvts.getRawParameterValue("REVERB_BYPASS")->load();
 
-    juce::dsp::Reverb::Parameters params;
+    juce::Reverb::Parameters params;
     params.roomSize   = apvts.getRawParameterValue("ROOM_SIZE")->load() / 100.0f;
     params.damping    = apvts.getRawParameterValue("DAMPING")->load() / 100.0f;
     params.width      = apvts.getRawParameterValue("WIDTH")->load() / 100.0f;
@@ -138,7 +159,74 @@ void A3AudioProcessor::updateReverb() {
     params.dryLevel   = apvts.getRawParameterValue("DRY_LEVEL")->load() / 100.0f;
     params.freezeMode = apvts.getRawParameterValue("FREEZE_MODE")->load();
 
-    reverb.setParameters(params);
+    float earlyLevel = apvts.getRawParameterValue("EARLY_LEVEL")->load() / 100.0f;
+    float irLength   = apvts.getRawParameterValue("IR_LENGTH")->load();
+
+    chain.setReverb(bypassReverb, params, earlyLevel, irLength);
+}
+
+void A3AudioProcessor::updateQualityTier(int numSamples, juce::int64 startTicks, double processingSeconds) {
+    int qualityChoice = *apvts.getRawParameterValue("QUALITY");
+
+    // Callback spacing, relative to how long the previous block lasts in real time
+    double intervalRatio = 0.0;
+    if (lastCallbackTicks > 0 && lastBlockSamples > 0 && getSampleRate() > 0.0)
+        intervalRatio = juce::Time::highResolutionTicksToSeconds(startTicks - lastCallbackTicks) /
+                        (lastBlockSamples / getSampleRate());
+    lastCallbackTicks = startTicks;
+    lastBlockSamples  = numSamples;
+
+    if (qualityChoice != QualityParams::AUTO) {
+        activeQualityTier     = static_cast<QualityTier>(qualityChoice - QualityParams::ECO);
+        averageLoad           = 0.0;
+        averageInterval       = 1.0;
+        blocksBelowStepUpLoad = 0;
+        blocksOverSpikeLoad   = 0;
+        return;
+    }
+
+    if (numSamples <= 0 || getSampleRate() <= 0.0 || isNonRealtime())
+        return;
+
+    // Every instance in the process shares the host's callback, so each one is held to an even split of the
+    // session's budget across the CPUs, capped at a single CPU's worth
+    double budget = numSamples / getSampleRate();
+    double share  = budget * QualityParams::AUTO_SESSION_SHARE *
+                    juce::jmin(1.0, (double) numCpus / juce::jmax(1, liveInstances.load()));
+    double load   = processingSeconds / share;
+    averageLoad += QualityParams::AUTO_LOAD_SMOOTHING * (load - averageLoad);
+
+    blocksOverSpikeLoad = load > QualityParams::AUTO_SPIKE_LOAD ? blocksOverSpikeLoad + 1 : 0;
+
+    if (intervalRatio > 0.0 && intervalRatio < QualityParams::AUTO_PAUSE_INTERVAL_RATIO)
+        averageInterval += QualityParams::AUTO_LOAD_SMOOTHING * (intervalRatio - averageInterval);
+
+    auto tier = static_cast<int>(activeQualityTier.load());
+
+    // A short run of blocks far over the share steps down straight away, while one stray block (a cold cache,
+    // a page fault) doesn't; the averages catch sustained overload, whether it shows up in our own processing
+    // time or as the host falling behind. Stepping back up needs a long run of cheap blocks, so the tier doesn't
+    // flap around the thresholds.
+    if (blocksOverSpikeLoad >= QualityParams::AUTO_SPIKE_BLOCKS || averageLoad > QualityParams::AUTO_STEP_DOWN_LOAD ||
+        averageInterval > QualityParams::AUTO_LATE_INTERVAL_RATIO) {
+        if (tier > static_cast<int>(QualityTier::eco)) {
+            --tier;
+            averageLoad         = 0.0;
+            averageInterval     = 1.0;
+            blocksOverSpikeLoad = 0;
+        }
+        blocksBelowStepUpLoad = 0;
+    } else if (averageLoad < QualityParams::AUTO_STEP_UP_LOAD) {
+        if (++blocksBelowStepUpLoad >= QualityParams::AUTO_STEP_UP_HOLD_BLOCKS) {
+            if (tier < static_cast<int>(QualityTier::high))
+                ++tier;
+            blocksBelowStepUpLoad = 0;
+        }
+    } else {
+        blocksBelowStepUpLoad = 0;
+    }
+
+    activeQualityTier = static_cast<QualityTier>(tier);
 }
 
 void A3AudioProcessor::releaseResources() {
@@ -170,24 +258,43 @@ bool A3AudioProcessor::isBusesLayoutSupported(const BusesLayout &layouts) const
 #endif
 
 void A3AudioProcessor::processBlock(juce::AudioBuffer<float> &buffer, juce::MidiBuffer &midiMessages) {
+    processChain(buffer, floatChain);
+}
+
+void A3AudioProcessor::processBlock(juce::AudioBuffer<double> &buffer, juce::MidiBuffer &midiMessages) {
+    processChain(buffer, doubleChain);
+}
+
+bool A3AudioProcessor::supportsDoublePrecisionProcessing() const {
+    return true;
+}
+
+template <typename SampleType>
+void A3AudioProcessor::processChain(juce::AudioBuffer<SampleType> &buffer, EffectChain<SampleType> &chain) {
     juce::ScopedNoDenormals noDenormals;
+    auto                    startTicks             = juce::Time::getHighResolutionTicks();
+    auto                    startCpuSeconds        = getThreadCpuSeconds();
     auto                    totalNumInputChannels  = getTotalNumInputChannels();
     auto                    totalNumOutputChannels = getTotalNumOutputChannels();
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear(i, 0, buffer.getNumSamples());
 
-    updateFX();
-    updateReverb();
-
-    juce::dsp::AudioBlock<float>              block(buffer);
-    juce::dsp::ProcessContextReplacing<float> context(block);
-
-    if (!bypassFilter)
-        stateVariableFilter.process(context);
-    if (!bypassPhaser)
-        fxChain.process(context);
-    if (!bypassReverb)
-        reverb.process(context);
+    juce::dsp::AudioBlock<SampleType> block(buffer);
+    auto                              tier = activeQualityTier.load();
+
+    if (tier != QualityTier::eco || ++blocksSinceParameterUpdate >= QualityParams::ECO_UPDATE_INTERVAL_BLOCKS) {
+        blocksSinceParameterUpdate = 0;
+        updateFX(chain);
+        updateReverb(chain);
+    }
+    chain.process(block, tier);
+
+    // Thread CPU time leaves out the time this thread sat preempted; wall-clock time stands in where it's missing
+    auto processingSeconds =
+        startCpuSeconds >= 0.0
+            ? getThreadCpuSeconds() - startCpuSeconds
+            : juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+    updateQualityTier(buffer.getNumSamples(), startTicks, processingSeconds);
 }
 
 //==============================================================================
@@ -201,14 +308,32 @@ juce::AudioProcessorEditor *A3AudioProcessor::createEditor() {
 
 //==============================================================================
 void A3AudioProcessor::getStateInformation(juce::MemoryBlock &destData) {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    // The IR path is stored as a property on the parameter state, so it travels with the session
+    if (auto xml = apvts.copyState().createXml())
+        copyXmlToBinary(*xml, destData);
 }
 
 void A3AudioProcessor::setStateInformation(const void *data, int sizeInBytes) {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    auto xml = getXmlFromBinary(data, sizeInBytes);
+    if (xml == nullptr || !xml->hasTagName(apvts.state.getType()))
+        return;
+
+    apvts.replaceState(juce::ValueTree::fromXml(*xml));
+
+    // Decoding and partitioning happen on the loader thread, so restoring a session never waits on them.
+    // A session without an IR unloads whatever the previous state had loaded.
+    auto irPath = apvts.state.getProperty("IR_FILE").toString();
+    impulseResponseLoader.setFile(irPath.isNotEmpty() ? juce::File(irPath) : juce::File());
+}
+
+void A3AudioProcessor::loadImpulseResponse(const juce::File &file) {
+    apvts.state.setProperty("IR_FILE", file.getFullPathName(), nullptr);
+    impulseResponseLoader.setFile(file);
+}
+
+void A3AudioProcessor::clearImpulseResponse() {
+    apvts.state.removeProperty("IR_FILE", nullptr);
+    impulseResponseLoader.setFile(juce::File());
 }
 
 //==============================================================================
@@ -226,6 +351,8 @@ juce::AudioProcessorValueTreeState::ParameterLayout A3AudioProcessor::createPara
     layout.add(std::make_unique<juce::AudioParameterFloat>("GAIN", "Gain", 0.0f, 2.0f, 1.0f));
     layout.add(std::make_unique<juce::AudioParameterInt>("FILTERMENU", "Filter Menu", 1, 4, 4));
     layout.add(std::make_unique<juce::AudioParameterInt>("PHASERMENU", "Phaser Menu", 1, 2, 2));
+    layout.add(std::make_unique<juce::AudioParameterInt>("QUALITY", "Quality", QualityParams::QUALITY_MIN,
+                                                         QualityParams::QUALITY_MAX, QualityParams::QUALITY_DEFAULT));
 
     // Reverb parameters
     layout.add(std::make_unique<juce::AudioParameterBool>("REVERB_BYPASS", "Reverb Bypass",
@@ -240,9 +367,14 @@ juce::AudioProcessorValueTreeState::ParameterLayout A3AudioProcessor::createPara
                                                          ReverbParams::WET_MAX, ReverbParams::WET_DEFAULT));
     layout.add(std::make_unique<juce::AudioParameterInt>("DRY_LEVEL", "Dry Level", ReverbParams::DRY_MIN,
                                                          ReverbParams::DRY_MAX, ReverbParams::DRY_DEFAULT));
+    layout.add(std::make_unique<juce::AudioParameterInt>("EARLY_LEVEL", "Early Level", ReverbParams::EARLY_MIN,
+                                                         ReverbParams::EARLY_MAX, ReverbParams::EARLY_DEFAULT));
 
     layout.add(
         std::make_unique<juce::AudioParameterBool>("FREEZE_MODE", "Freeze Mode", ReverbParams::FREEZE_MODE_DEFAULT));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("IR_LENGTH", "IR Length", ReverbParams::IR_LENGTH_MIN,
+                                                           ReverbParams::IR_LENGTH_MAX,
+                                                           ReverbParams::IR_LENGTH_DEFAULT));
 
     // Chorus parameters
     layout.add(std::make_unique<juce::AudioParameterBool>("CHORUS_BYPASS", "Chorus Bypass",
@@ -9,6 +9,9 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "ConvolutionReverb.h"
+#include "EffectChain.h"
+#include "ImpulseResponseLoader.h"
 
 //==============================================================================
 /**
@@ -28,6 +31,8 @@ public:
 #endif
 
     void processBlock(juce::AudioBuffer<float> &, juce::MidiBuffer &) override;
+    void processBlock(juce::AudioBuffer<double> &, juce::MidiBuffer &) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor *createEditor() override;
@@ -52,25 +57,56 @@ public:
     void getStateInformation(juce::MemoryBlock &destData) override;
     void setStateInformation(const void *data, int sizeInBytes) override;
 
-    void                               updateFX();
     void                               updateParameters();
     juce::AudioProcessorValueTreeState apvts;
 
+    //===== Quality =====
+
+    QualityTier getActiveQualityTier() const { return activeQualityTier.load(); }
+
+    //===== Impulse Response =====
+
+    void loadImpulseResponse(const juce::File &file);
+    void clearImpulseResponse();
+    bool hasImpulseResponse() const { return convolutionReverb.isLoaded(); }
+
 private:
     juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
 
-    juce::dsp::StateVariableTPTFilter<float> stateVariableFilter;
-    bool                                     bypassFilter = false;
+    //===== Effect Chains =====
+
+    // Only the chain matching the host's processing precision is prepared and run
+    EffectChain<float>  floatChain;
+    EffectChain<double> doubleChain;
+
+    template <typename SampleType>
+    void prepareChain(EffectChain<SampleType> &chain, const juce::dsp::ProcessSpec &spec);
+    template <typename SampleType>
+    void processChain(juce::AudioBuffer<SampleType> &buffer, EffectChain<SampleType> &chain);
+    template <typename SampleType> void updateFX(EffectChain<SampleType> &chain);
+    template <typename SampleType> void updateReverb(EffectChain<SampleType> &chain);
+
+    //===== Impulse Response =====
+
+    ConvolutionReverb     convolutionReverb;
+    ImpulseResponseLoader impulseResponseLoader;
+
+    //===== Quality =====
 
-    enum { phaserIndex, gainIndex };
-    juce::dsp::ProcessorChain<juce::dsp::Phaser<float>, juce::dsp::Gain<float>> fxChain;
-    bool                                                                        bypassPhaser = false;
+    // Instances in this process, so Auto can split the session's budget between them
+    inline static std::atomic<int> liveInstances{0};
 
-    //===== Reverb =====
+    std::atomic<QualityTier> activeQualityTier{QualityTier::normal};
+    int                      numCpus                    = 1;
+    double                   averageLoad                = 0.0;
+    double                   averageInterval            = 1.0;
+    int                      blocksBelowStepUpLoad      = 0;
+    int                      blocksOverSpikeLoad        = 0;
+    int                      blocksSinceParameterUpdate = 0;
+    int                      lastBlockSamples           = 0;
+    juce::int64              lastCallbackTicks          = 0;
 
-    juce::dsp::Reverb reverb;
-    void              updateReverb();
-    bool              bypassReverb = false;
+    void updateQualityTier(int numSamples, juce::int64 startTicks, double processingSeconds);
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(A3AudioProcessor)
@@ -0,0 +1,42 @@
+#pragma once
+
+struct QualityParams {
+    // Menu indices for the QUALITY parameter (1-based, like FILTERMENU and PHASERMENU)
+    inline static constexpr int ECO    = 1;
+    inline static constexpr int NORMAL = 2;
+    inline static constexpr int HIGH   = 3;
+    inline static constexpr int AUTO   = 4;
+
+    inline static constexpr int QUALITY_DEFAULT = NORMAL;
+    inline static constexpr int QUALITY_MIN     = ECO;
+    inline static constexpr int QUALITY_MAX     = AUTO;
+
+    // Eco only re-reads parameters every N blocks
+    inline static constexpr int ECO_UPDATE_INTERVAL_BLOCKS = 4;
+
+    // Early-reflection tap count per tier
+    inline static constexpr int ECO_EARLY_TAPS    = 16;
+    inline static constexpr int NORMAL_EARLY_TAPS = 24;
+    inline static constexpr int HIGH_EARLY_TAPS   = 32;
+
+    // Longest stretch of a loaded IR convolved per tier, in seconds; high covers the whole IR_LENGTH range
+    inline static constexpr double ECO_IR_SECONDS    = 1.5;
+    inline static constexpr double NORMAL_IR_SECONDS = 4.0;
+    inline static constexpr double HIGH_IR_SECONDS   = 6.0;
+
+    // Auto mode. All live instances together get AUTO_SESSION_SHARE of every CPU's block budget, split evenly;
+    // the load thresholds below are fractions of one instance's share.
+    inline static constexpr double AUTO_SESSION_SHARE       = 0.5;
+    inline static constexpr double AUTO_LOAD_SMOOTHING      = 0.1;
+    inline static constexpr double AUTO_STEP_DOWN_LOAD      = 1.0;
+    inline static constexpr double AUTO_SPIKE_LOAD          = 2.0;
+    inline static constexpr int    AUTO_SPIKE_BLOCKS        = 3; // consecutive blocks over AUTO_SPIKE_LOAD
+    inline static constexpr double AUTO_STEP_UP_LOAD        = 0.4;
+    inline static constexpr int    AUTO_STEP_UP_HOLD_BLOCKS = 500;
+
+    // Auto mode also watches the time between callbacks against the previous block's duration. A smoothed
+    // ratio above AUTO_LATE_INTERVAL_RATIO means the host is missing deadlines; single gaps longer than
+    // AUTO_PAUSE_INTERVAL_RATIO are transport stops and are ignored.
+    inline static constexpr double AUTO_LATE_INTERVAL_RATIO  = 1.2;
+    inline static constexpr double AUTO_PAUSE_INTERVAL_RATIO = 4.0;
+};
@@ -28,6 +28,11 @@ struct ReverbParams {
     inline static constexpr int DRY_MAX     = 100;
     inline static constexpr int DRY_STEP    = 1;
 
+    inline static constexpr int EARLY_DEFAULT = 50;
+    inline static constexpr int EARLY_MIN     = 0;
+    inline static constexpr int EARLY_MAX     = 100;
+    inline static constexpr int EARLY_STEP    = 1;
+
     inline static constexpr bool FREEZE_MODE_DEFAULT = false;
 
     inline static constexpr float IR_LENGTH_DEFAULT = 3.0f;
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Freeverb comb/all-pass tank, ported from juce::Reverb and templated on the
+    sample type so freeze and long feedback run at the host's precision.
+
+    Tunings, scale factors and smoothing match juce::Reverb, so the float chain
+    sounds the same as before.
+
+    Both channels' tanks are fed the same mid signal, so single-tank mode runs
+    only the left one and uses it for both wet outputs; the dry signal stays
+    stereo. Switching in and out of it crossfades the right tank's output.
+
+    Early reflections are fed into the tanks with the dry signal and mixed into
+    the output with the tank's, at the wet gains.
+ */
+template <typename SampleType> class ReverbTank {
+public:
+    using Parameters = juce::Reverb::Parameters; // same fields and ranges as juce::Reverb
+
+    inline static constexpr float WET_SCALE_FACTOR = 3.0f;
+    inline static constexpr float DRY_SCALE_FACTOR = 2.0f;
+
+    void prepare(const juce::dsp::ProcessSpec &spec) {
+        static const short combTunings[]    = {1116, 1188, 1277, 1356, 1422, 1491, 1557, 1617}; // at 44.1 kHz
+        static const short allPassTunings[] = {556, 441, 341, 225};
+        const int          stereoSpread     = 23;
+        const int          intSampleRate    = (int) spec.sampleRate;
+
+        for (int ch = 0; ch < NUM_CHANNELS; ++ch) {
+            for (int i = 0; i < NUM_COMBS; ++i)
+                comb[ch][i].setSize((intSampleRate * (combTunings[i] + ch * stereoSpread)) / 44100);
+
+            for (int i = 0; i < NUM_ALL_PASSES; ++i)
+                allPass[ch][i].setSize((intSampleRate * (allPassTunings[i] + ch * stereoSpread)) / 44100);
+        }
+
+        const double smoothTime = 0.01;
+        damping.reset(spec.sampleRate, smoothTime);
+        feedback.reset(spec.sampleRate, smoothTime);
+        dryGain.reset(spec.sampleRate, smoothTime);
+        wetGain1.reset(spec.sampleRate, smoothTime);
+        wetGain2.reset(spec.sampleRate, smoothTime);
+
+        rightTankMix.reset(spec.sampleRate, TANK_FADE_SECONDS);
+        rightTankMix.setCurrentAndTargetValue(singleTank ? SampleType(0) : SampleType(1));
+
+        reset();
+    }
+
+    void reset() {
+        for (int ch = 0; ch < NUM_CHANNELS; ++ch)
+            clearTank(ch);
+    }
+
+    void setParameters(const Parameters &newParams) {
+        auto wet = newParams.wetLevel * WET_SCALE_FACTOR;
+        dryGain.setTargetValue(static_cast<SampleType>(newParams.dryLevel * DRY_SCALE_FACTOR));
+        wetGain1.setTargetValue(static_cast<SampleType>(0.5f * wet * (1.0f + newParams.width)));
+        wetGain2.setTargetValue(static_cast<SampleType>(0.5f * wet * (1.0f - newParams.width)));
+
+        const bool frozen = newParams.freezeMode >= 0.5f;
+        gain              = frozen ? SampleType(0) : static_cast<SampleType>(0.015);
+
+        if (frozen) {
+            damping.setTargetValue(SampleType(0));
+            feedback.setTargetValue(SampleType(1));
+        } else {
+            damping.setTargetValue(static_cast<SampleType>(newParams.damping * 0.4f));
+            feedback.setTargetValue(static_cast<SampleType>(newParams.roomSize * 0.28f + 0.7f));
+        }
+    }
+
+    void setSingleTank(bool shouldUseSingleTank) {
+        if (shouldUseSingleTank == singleTank)
+            return;
+
+        // The right tank stopped running when the last fade to single finished, so start it from silence
+        if (!shouldUseSingleTank && !isRightTankRunning())
+            clearTank(1);
+
+        singleTank = shouldUseSingleTank;
+        rightTankMix.setTargetValue(singleTank ? SampleType(0) : SampleType(1));
+    }
+
+    // early holds the early reflections for block, with the same length and channel count
+    void process(juce::dsp::AudioBlock<SampleType> &block, const juce::dsp::AudioBlock<SampleType> &early) {
+        auto numSamples = (int) block.getNumSamples();
+
+        if (block.getNumChannels() == 1)
+            processMono(block.getChannelPointer(0), early.getChannelPointer(0), numSamples);
+        else if (block.getNumChannels() >= 2)
+            processStereo(block.getChannelPointer(0), block.getChannelPointer(1), early.getChannelPointer(0),
+                          early.getChannelPointer(1), numSamples);
+    }
+
+private:
+    inline static constexpr int    NUM_COMBS         = 8;
+    inline static constexpr int    NUM_ALL_PASSES    = 4;
+    inline static constexpr int    NUM_CHANNELS      = 2;
+    inline static constexpr double TANK_FADE_SECONDS = 0.1;
+
+    class CombFilter {
+    public:
+        void setSize(int size) {
+            buffer.assign((size_t) juce::jmax(1, size), SampleType(0));
+            index = 0;
+            last  = SampleType(0);
+        }
+
+        void clear() {
+            std::fill(buffer.begin(), buffer.end(), SampleType(0));
+            last = SampleType(0);
+        }
+
+        SampleType process(SampleType input, SampleType damp, SampleType feedbackLevel) noexcept {
+            auto output   = buffer[index];
+            last          = output * (SampleType(1) - damp) + last * damp;
+            buffer[index] = input + last * feedbackLevel;
+
+            if (++index == buffer.size())
+                index = 0;
+            return output;
+        }
+
+    private:
+        std::vector<SampleType> buffer;
+        size_t                  index = 0;
+        SampleType              last  = SampleType(0);
+    };
+
+    class AllPassFilter {
+    public:
+        void setSize(int size) {
+            buffer.assign((size_t) juce::jmax(1, size), SampleType(0));
+            index = 0;
+        }
+
+        void clear() { std::fill(buffer.begin(), buffer.end(), SampleType(0)); }
+
+        SampleType process(SampleType input) noexcept {
+            auto bufferedValue = buffer[index];
+            buffer[index]      = input + bufferedValue * SampleType(0.5);
+
+            if (++index == buffer.size())
+                index = 0;
+            return bufferedValue - input;
+        }
+
+    private:
+        std::vector<SampleType> buffer;
+        size_t                  index = 0;
+    };
+
+    void clearTank(int ch) {
+        for (auto &filter : comb[ch])
+            filter.clear();
+        for (auto &filter : allPass[ch])
+            filter.clear();
+    }
+
+    bool isRightTankRunning() const { return rightTankMix.isSmoothing() || rightTankMix.getTargetValue() > 0; }
+
+    SampleType processTank(int ch, SampleType input, SampleType damp, SampleType fb) noexcept {
+        SampleType output = 0;
+        for (int j = 0; j < NUM_COMBS; ++j)
+            output += comb[ch][j].process(input, damp, fb);
+        for (int j = 0; j < NUM_ALL_PASSES; ++j)
+            output = allPass[ch][j].process(output);
+        return output;
+    }
+
+    void processStereo(SampleType *left, SampleType *right, const SampleType *earlyLeft, const SampleType *earlyRight,
+                       int numSamples) noexcept {
+        const bool runRightTank = isRightTankRunning();
+
+        for (int i = 0; i < numSamples; ++i) {
+            auto input = (left[i] + right[i] + earlyLeft[i] + earlyRight[i]) * gain;
+            auto damp  = damping.getNextValue();
+            auto fb    = feedback.getNextValue();
+
+            auto outL = processTank(0, input, damp, fb);
+            auto outR = outL;
+            if (runRightTank)
+                outR += rightTankMix.getNextValue() * (processTank(1, input, damp, fb) - outL);
+
+            auto wetL = outL + earlyLeft[i];
+            auto wetR = outR + earlyRight[i];
+            auto dry  = dryGain.getNextValue();
+            auto wet1 = wetGain1.getNextValue();
+            auto wet2 = wetGain2.getNextValue();
+            left[i]   = wetL * wet1 + wetR * wet2 + left[i] * dry;
+            right[i]  = wetR * wet1 + wetL * wet2 + right[i] * dry;
+        }
+    }
+
+    void processMono(SampleType *samples, const SampleType *early, int numSamples) noexcept {
+        for (int i = 0; i < numSamples; ++i) {
+            auto input = (samples[i] + early[i]) * gain;
+            auto damp  = damping.getNextValue();
+            auto fb    = feedback.getNextValue();
+
+            auto output = processTank(0, input, damp, fb);
+
+            auto dry   = dryGain.getNextValue();
+            auto wet1  = wetGain1.getNextValue();
+            samples[i] = (output + early[i]) * wet1 + samples[i] * dry;
+        }
+    }
+
+    CombFilter    comb[NUM_CHANNELS][NUM_COMBS];
+    AllPassFilter allPass[NUM_CHANNELS][NUM_ALL_PASSES];
+
+    juce::SmoothedValue<SampleType> damping, feedback, dryGain, wetGain1, wetGain2;
+    juce::SmoothedValue<SampleType> rightTankMix;
+    SampleType                      gain       = static_cast<SampleType>(0.015);
+    bool                            singleTank = false;
+};